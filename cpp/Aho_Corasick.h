@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+
+// One weighted keyword of a lexicon (see js/data.json); category indexes the
+// lexicon's category table.
+struct LexiconEntry {
+	const char* word;
+	int weight;
+	int category;
+	const char* suggestion;
+};
+
+
+// Aho-Corasick Automaton built by the compiler
+// The sizes come from the code generator (cpp/Lexicon_Codegen.cpp), which
+// counts the trie states and byte classes of the lexicon; the constructor
+// then builds the trie, the failure links and the completed transition
+// table as constexpr data, so a constexpr instance lives in read-only memory
+// and needs no start-up work. Upper-case ASCII shares the class of its
+// lower-case letter, so scanning is case-insensitive without copying text.
+template <int STATES, int CLASSES, int KEYWORDS>
+struct StaticAhoCorasick {
+	using State = conditional_t<(STATES < 65536), uint16_t, uint32_t>;
+
+	unsigned char byteClass[256] = {};
+	State delta[STATES * CLASSES] = {};
+	// Keywords ending exactly at a state: outIds[outStart[s] .. outStart[s + 1])
+	int outStart[STATES + 1] = {};
+	int outIds[KEYWORDS] = {};
+	// First state with outputs reachable from s by failure links (s itself
+	// when it has outputs of its own), 0 when there is none
+	State reportFrom[STATES] = {};
+	State dictLink[STATES] = {};
+	int length[KEYWORDS] = {};
+	int states = 0;
+
+
+	constexpr StaticAhoCorasick(const LexiconEntry (&entries)[KEYWORDS]) {
+		int classes = 1;
+		for (int k = 0; k < KEYWORDS; k++) {
+			for (const char* p = entries[k].word; *p; p++) {
+				unsigned char c = *p;
+				if (byteClass[c] == 0)
+					byteClass[c] = classes++;
+			}
+		}
+		for (int c = 'A'; c <= 'Z'; c++) {
+			if (byteClass[c] == 0)
+				byteClass[c] = byteClass[c - 'A' + 'a'];
+		}
+
+		// Trie; a zero transition means "no child" until the table is completed
+		int terminal[KEYWORDS] = {};
+		int ownCount[STATES] = {};
+		states = 1;
+		for (int k = 0; k < KEYWORDS; k++) {
+			int s = 0, len = 0;
+			for (const char* p = entries[k].word; *p; p++, len++) {
+				int c = byteClass[(unsigned char)*p];
+				if (delta[s * CLASSES + c] == 0)
+					delta[s * CLASSES + c] = states++;
+				s = delta[s * CLASSES + c];
+			}
+			terminal[k] = s;
+			length[k] = len;
+			ownCount[s]++;
+		}
+
+		for (int s = 0; s < STATES; s++)
+			outStart[s + 1] = outStart[s] + ownCount[s];
+		int fill[STATES] = {};
+		for (int k = 0; k < KEYWORDS; k++) {
+			int s = terminal[k];
+			outIds[outStart[s] + fill[s]++] = k;
+		}
+
+		// Breadth-first failure links; every row is completed from the row
+		// of its failure state, which is shallower and therefore done already
+		int fail[STATES] = {};
+		int queue[STATES] = {};
+		int head = 0, tail = 0;
+		for (int c = 0; c < CLASSES; c++) {
+			int v = delta[c];
+			if (v != 0)
+				queue[tail++] = v;
+		}
+		while (head < tail) {
+			int u = queue[head++];
+			for (int c = 0; c < CLASSES; c++) {
+				int v = delta[u * CLASSES + c];
+				int next = delta[fail[u] * CLASSES + c];
+				if (v != 0) {
+					fail[v] = next;
+					queue[tail++] = v;
+				}
+				else {
+					delta[u * CLASSES + c] = next;
+				}
+			}
+			int f = fail[u];
+			dictLink[u] = ownCount[f] > 0 ? f : dictLink[f];
+			reportFrom[u] = ownCount[u] > 0 ? u : dictLink[u];
+		}
+	}
+
+
+	constexpr int stateCount() const { return states; }
+
+
+	int next(int state, unsigned char c) const {
+		return delta[state * CLASSES + byteClass[c]];
+	}
+
+
+	// Calls onMatch(keyword, start) for every keyword ending at byte end
+	// once the automaton has reached state
+	template <typename F>
+	void report(int state, int end, F& onMatch) const {
+		for (int t = reportFrom[state]; t != 0; t = dictLink[t]) {
+			for (int o = outStart[t]; o < outStart[t + 1]; o++)
+				onMatch(outIds[o], end - length[outIds[o]] + 1);
+		}
+	}
+
+
+	// Calls onMatch(keyword, start) for every keyword occurrence in s[0, n)
+	template <typename F>
+	void scan(const char* s, int n, F onMatch) const {
+		int st = 0;
+		for (int i = 0; i < n; i++) {
+			st = next(st, s[i]);
+			report(st, i, onMatch);
+		}
+	}
+};
+
+
+// Aho-Corasick Automaton built at run time
+// Same tables and interface as StaticAhoCorasick, for keyword sets that are
+// only known once the program runs (a lexicon loaded from disk).
+class AhoCorasick {
+protected:
+	int classes = 1;
+	unsigned char byteClass[256] = {};
+	vector<uint32_t> delta;
+	vector<int> outStart;
+	vector<int> outIds;
+	vector<int> reportFrom;
+	vector<int> dictLink;
+	vector<int> length;
+
+public:
+	AhoCorasick() {
+		delta.assign(1, 0);
+		outStart.assign(2, 0);
+		reportFrom.assign(1, 0);
+		dictLink.assign(1, 0);
+	}
+
+
+	AhoCorasick(const vector<string>& keywords) {
+		for (const auto& word : keywords) {
+			for (unsigned char c : word) {
+				if (byteClass[c] == 0)
+					byteClass[c] = classes++;
+			}
+		}
+		for (int c = 'A'; c <= 'Z'; c++) {
+			if (byteClass[c] == 0)
+				byteClass[c] = byteClass[c - 'A' + 'a'];
+		}
+
+		int k = keywords.size();
+		vector<int> terminal(k);
+		length.resize(k);
+		delta.assign(classes, 0);
+		int states = 1;
+		for (int i = 0; i < k; i++) {
+			int s = 0;
+			for (unsigned char c : keywords[i]) {
+				int at = s * classes + byteClass[c];
+				if (delta[at] == 0) {
+					delta[at] = states++;
+					delta.resize(states * classes, 0);
+				}
+				s = delta[at];
+			}
+			terminal[i] = s;
+			length[i] = keywords[i].length();
+		}
+
+		// Keywords are grouped by terminal state (a stable counting sort)
+		outStart.assign(states + 1, 0);
+		for (int i = 0; i < k; i++)
+			outStart[terminal[i] + 1]++;
+		for (int s = 0; s < states; s++)
+			outStart[s + 1] += outStart[s];
+		outIds.resize(k);
+		vector<int> fill(outStart.begin(), outStart.end() - 1);
+		for (int i = 0; i < k; i++)
+			outIds[fill[terminal[i]]++] = i;
+
+		vector<int> fail(states, 0);
+		vector<int> queue;
+		queue.reserve(states);
+		reportFrom.assign(states, 0);
+		dictLink.assign(states, 0);
+		for (int c = 0; c < classes; c++) {
+			if (delta[c] != 0)
+				queue.push_back(delta[c]);
+		}
+		for (size_t head = 0; head < queue.size(); head++) {
+			int u = queue[head];
+			for (int c = 0; c < classes; c++) {
+				int v = delta[u * classes + c];
+				int next = delta[fail[u] * classes + c];
+				if (v != 0) {
+					fail[v] = next;
+					queue.push_back(v);
+				}
+				else {
+					delta[u * classes + c] = next;
+				}
+			}
+			int f = fail[u];
+			bool fOwn = outStart[f + 1] > outStart[f];
+			bool uOwn = outStart[u + 1] > outStart[u];
+			dictLink[u] = fOwn ? f : dictLink[f];
+			reportFrom[u] = uOwn ? u : dictLink[u];
+		}
+	}
+
+
+	int stateCount() const { return reportFrom.size(); }
+
+
+	int next(int state, unsigned char c) const {
+		return delta[state * classes + byteClass[c]];
+	}
+
+
+	template <typename F>
+	void report(int state, int end, F& onMatch) const {
+		for (int t = reportFrom[state]; t != 0; t = dictLink[t]) {
+			for (int o = outStart[t]; o < outStart[t + 1]; o++)
+				onMatch(outIds[o], end - length[outIds[o]] + 1);
+		}
+	}
+
+
+	template <typename F>
+	void scan(const char* s, int n, F onMatch) const {
+		int st = 0;
+		for (int i = 0; i < n; i++) {
+			st = next(st, s[i]);
+			report(st, i, onMatch);
+		}
+	}
+};
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <deque>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+
+// Read-only memory mapping of a whole file. When the file cannot be mapped
+// (a pipe, an empty file) its contents are read into memory instead, so
+// callers always get one contiguous buffer.
+class MappedFile {
+protected:
+	const char* mapped = nullptr;
+	size_t length = 0;
+	string fallback;
+	bool isMapped = false;
+
+
+	void release() {
+		if (isMapped) munmap((void*)mapped, length);
+		mapped = nullptr;
+		length = 0;
+		isMapped = false;
+		fallback.clear();
+	}
+
+public:
+	MappedFile() {}
+
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+
+	~MappedFile() {
+		release();
+	}
+
+
+	bool open(const string& path) {
+		release();
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat info;
+		if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+			void* p = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p != MAP_FAILED) {
+				mapped = (const char*)p;
+				length = info.st_size;
+				isMapped = true;
+				::close(fd);
+				return true;
+			}
+		}
+		::close(fd);
+
+		ifstream in(path, ios::binary);
+		if (!in) return false;
+		stringstream buffer;
+		buffer << in.rdbuf();
+		fallback = buffer.str();
+		mapped = fallback.data();
+		length = fallback.size();
+		return true;
+	}
+
+
+	const char* data() const { return mapped; }
+
+
+	size_t size() const { return length; }
+
+
+	string_view view() const { return string_view(mapped, length); }
+};
+
+
+// Columnar result of CsvReader: columns[c][r] is field c of row r. Fields
+// point into the parsed buffer, which must outlive the table; only fields
+// with quotes inside them (rare) are copied into `unquoted`.
+struct CsvTable {
+	vector<string_view> headers;
+	vector<vector<string_view>> columns;
+	deque<string> unquoted;
+	int rows = 0;
+
+	// Index of the named column, -1 when absent
+	int column(string_view name) const {
+		for (size_t c = 0; c < headers.size(); c++) {
+			if (headers[c] == name) return c;
+		}
+		return -1;
+	}
+
+	// Field of a named column, "" when the column is absent
+	string_view field(int column, int row) const {
+		return column < 0 ? string_view() : columns[column][row];
+	}
+};
+
+
+// CSV Reader
+// Parses with the rules of parseCSV() / parseCSVLine() in js/search.js:
+// every '\n' ends a row, a '"' toggles quoting (commas inside quotes do not
+// split) and is dropped, fields and rows are trimmed, blank rows skipped,
+// missing fields are "". The buffer is classified 64 bytes at a time: SSE2
+// compares build bit masks of the quotes, commas and newlines, and a prefix
+// XOR of the quote mask gives the quoting parity of every byte, so only the
+// delimiter bits are visited, never the bytes in between.
+class CsvReader {
+protected:
+	const char* s;
+	size_t n;
+
+
+	static bool isSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+	}
+
+
+	static string_view trim(string_view v) {
+		while (!v.empty() && isSpace(v.front())) v.remove_prefix(1);
+		while (!v.empty() && isSpace(v.back())) v.remove_suffix(1);
+		return v;
+	}
+
+
+	// Bit i set when byte i of the block equals c
+	static void blockMasks(const char* p, uint64_t& quotes, uint64_t& commas, uint64_t& newlines) {
+		quotes = commas = newlines = 0;
+#ifdef __SSE2__
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i comma = _mm_set1_epi8(',');
+		const __m128i newline = _mm_set1_epi8('\n');
+		for (int k = 0; k < 64; k += 16) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(p + k));
+			quotes |= uint64_t((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, quote))) << k;
+			commas |= uint64_t((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, comma))) << k;
+			newlines |= uint64_t((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, newline))) << k;
+		}
+#else
+		for (int k = 0; k < 64; k++) {
+			quotes |= uint64_t(p[k] == '"') << k;
+			commas |= uint64_t(p[k] == ',') << k;
+			newlines |= uint64_t(p[k] == '\n') << k;
+		}
+#endif
+	}
+
+
+	// Bit i becomes the XOR of bits 0..i
+	static uint64_t prefixXor(uint64_t x) {
+		x ^= x << 1;
+		x ^= x << 2;
+		x ^= x << 4;
+		x ^= x << 8;
+		x ^= x << 16;
+		x ^= x << 32;
+		return x;
+	}
+
+
+	// A raw field without its quotes, trimmed; copied only when quotes
+	// appear anywhere but around the whole field
+	static string_view clean(string_view raw, CsvTable& table) {
+		raw = trim(raw);
+		if (raw.find('"') == string_view::npos) return raw;
+		if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"'
+			&& raw.substr(1, raw.size() - 2).find('"') == string_view::npos)
+			return trim(raw.substr(1, raw.size() - 2));
+
+		string copy;
+		for (char c : raw) {
+			if (c != '"') copy += c;
+		}
+		table.unquoted.push_back(move(copy));
+		return trim(table.unquoted.back());
+	}
+
+public:
+	CsvReader(const char* data, size_t size) : s(data), n(size) {}
+
+
+	CsvReader(string_view data) : s(data.data()), n(data.size()) {}
+
+
+	void parse(CsvTable& table) {
+		table = CsvTable();
+		vector<string_view> row;
+		size_t fieldStart = 0, lineStart = 0;
+		bool header = true;
+
+		auto endRow = [&](size_t lineEnd) {
+			if (header) {
+				table.headers = row;
+				table.columns.resize(row.size());
+				header = false;
+			}
+			else if (!trim(string_view(s + lineStart, lineEnd - lineStart)).empty()) {
+				for (size_t c = 0; c < table.columns.size(); c++)
+					table.columns[c].push_back(c < row.size() ? row[c] : string_view());
+				table.rows++;
+			}
+			row.clear();
+		};
+
+		// Quoting parity at the start of the current line; a comma splits
+		// only when the parity before it is the same
+		uint64_t lineParity = 0;
+		uint64_t carry = 0;
+		for (size_t block = 0; block < n; block += 64) {
+			const char* p = s + block;
+			char padded[64];
+			if (n - block < 64) {
+				memset(padded, ' ', 64);
+				memcpy(padded, p, n - block);
+				p = padded;
+			}
+
+			uint64_t quotes, commas, newlines;
+			blockMasks(p, quotes, commas, newlines);
+			uint64_t parity = prefixXor(quotes) ^ carry;
+			carry = (parity >> 63) ? ~uint64_t(0) : 0;
+
+			for (uint64_t special = commas | newlines; special; special &= special - 1) {
+				int bit = __builtin_ctzll(special);
+				size_t at = block + bit;
+				uint64_t inQuotes = (parity >> bit) & 1;
+				if ((newlines >> bit) & 1) {
+					row.push_back(clean(string_view(s + fieldStart, at - fieldStart), table));
+					endRow(at);
+					fieldStart = lineStart = at + 1;
+					lineParity = inQuotes;
+				}
+				else if (inQuotes == lineParity) {
+					row.push_back(clean(string_view(s + fieldStart, at - fieldStart), table));
+					fieldStart = at + 1;
+				}
+			}
+		}
+		row.push_back(clean(string_view(s + fieldStart, n - fieldStart), table));
+		endRow(n);
+	}
+};
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <queue>
+#include <algorithm>
+
+#include "Suffix_Array.h"
+
+using namespace std;
+
+
+// Bit vector with constant-time rank: a 32-bit count of the ones before
+// every 512-bit block (6.25% on top of the bits), popcounts inside a block.
+class RankBitVector {
+protected:
+	static const int BLOCK_WORDS = 8;
+
+	vector<uint64_t> words;
+	vector<uint32_t> blocks;
+	size_t size = 0;
+
+public:
+	RankBitVector() {}
+
+
+	RankBitVector(size_t length) : words((length + 63) / 64), size(length) {}
+
+
+	void set(size_t i) {
+		words[i / 64] |= uint64_t(1) << (i % 64);
+	}
+
+
+	bool get(size_t i) const {
+		return (words[i / 64] >> (i % 64)) & 1;
+	}
+
+
+	// Builds the rank directory, call once every bit is set
+	void finish() {
+		blocks.assign(words.size() / BLOCK_WORDS + 1, 0);
+		uint32_t ones = 0;
+		for (size_t w = 0; w < words.size(); w++) {
+			if (w % BLOCK_WORDS == 0) blocks[w / BLOCK_WORDS] = ones;
+			ones += __builtin_popcountll(words[w]);
+		}
+		if (words.size() % BLOCK_WORDS == 0) blocks.back() = ones;
+	}
+
+
+	// Ones in [0, i)
+	size_t rank1(size_t i) const {
+		size_t w = i / 64;
+		size_t ones = blocks[w / BLOCK_WORDS];
+		for (size_t k = w / BLOCK_WORDS * BLOCK_WORDS; k < w; k++)
+			ones += __builtin_popcountll(words[k]);
+		if (i % 64) ones += __builtin_popcountll(words[w] & ((uint64_t(1) << (i % 64)) - 1));
+		return ones;
+	}
+
+
+	size_t length() const { return size; }
+
+
+	size_t bytes() const {
+		return words.size() * sizeof(uint64_t) + blocks.size() * sizeof(uint32_t);
+	}
+};
+
+
+// Huffman-shaped Wavelet Tree
+// Stores a byte sequence as one bit vector per internal node of its Huffman
+// tree: a symbol's code is its path from the root, and every node keeps, for
+// each symbol passing through it, the bit that sends it left or right. The
+// whole tree takes about H0 bits per symbol, rank(c, i) costs one bit-vector
+// rank per code bit.
+class WaveletTree {
+protected:
+	struct Node {
+		// Child node index, or -(symbol + 1) for a leaf
+		int child[2];
+		RankBitVector bits;
+	};
+
+	vector<Node> nodes;
+	int root = -1;
+	uint64_t code[256] = {};
+	int codeLength[256] = {};
+
+
+	void assignCodes(int node, uint64_t path, int depth) {
+		for (int b = 0; b < 2; b++) {
+			int child = nodes[node].child[b];
+			uint64_t next = path | (uint64_t(b) << depth);
+			if (child < 0) {
+				code[-child - 1] = next;
+				codeLength[-child - 1] = depth + 1;
+			}
+			else assignCodes(child, next, depth + 1);
+		}
+	}
+
+public:
+	WaveletTree() {}
+
+
+	WaveletTree(const vector<unsigned char>& s) {
+		size_t frequency[256] = {};
+		for (unsigned char c : s)
+			frequency[c]++;
+
+		// Huffman tree; a lone symbol gets a partner so the root exists
+		typedef pair<size_t, int> Item;
+		priority_queue<Item, vector<Item>, greater<Item>> heap;
+		for (int c = 0; c < 256; c++) {
+			if (frequency[c] > 0) heap.push({ frequency[c], -(c + 1) });
+		}
+		while (heap.size() < 2)
+			heap.push({ 0, -(heap.empty() || heap.top().second != -1 ? 1 : 2) });
+
+		vector<size_t> lengths;
+		while (heap.size() > 1) {
+			Item a = heap.top();
+			heap.pop();
+			Item b = heap.top();
+			heap.pop();
+			nodes.push_back({ { a.second, b.second }, RankBitVector() });
+			lengths.push_back(a.first + b.first);
+			heap.push({ a.first + b.first, int(nodes.size()) - 1 });
+		}
+		root = heap.top().second;
+		assignCodes(root, 0, 0);
+
+		// Route every symbol down its path, appending one bit per node
+		for (size_t k = 0; k < nodes.size(); k++)
+			nodes[k].bits = RankBitVector(lengths[k]);
+		vector<size_t> filled(nodes.size(), 0);
+		for (unsigned char c : s) {
+			int node = root;
+			for (int d = 0; d < codeLength[c]; d++) {
+				int b = (code[c] >> d) & 1;
+				size_t at = filled[node]++;
+				if (b) nodes[node].bits.set(at);
+				node = nodes[node].child[b];
+			}
+		}
+		for (auto& node : nodes)
+			node.bits.finish();
+	}
+
+
+	// Occurrences of c in [0, i)
+	size_t rank(unsigned char c, size_t i) const {
+		if (codeLength[c] == 0) return 0;
+		int node = root;
+		for (int d = 0; d < codeLength[c] && i > 0; d++) {
+			const RankBitVector& bits = nodes[node].bits;
+			size_t ones = bits.rank1(i);
+			int b = (code[c] >> d) & 1;
+			i = b ? ones : i - ones;
+			node = nodes[node].child[b];
+		}
+		return i;
+	}
+
+
+	// Symbol at i; rank receives its occurrences in [0, i)
+	unsigned char access(size_t i, size_t& rank) const {
+		int node = root;
+		while (node >= 0) {
+			const RankBitVector& bits = nodes[node].bits;
+			int b = bits.get(i);
+			size_t ones = bits.rank1(i);
+			i = b ? ones : i - ones;
+			node = nodes[node].child[b];
+		}
+		rank = i;
+		return -node - 1;
+	}
+
+
+	size_t bytes() const {
+		size_t total = sizeof(*this);
+		for (const auto& node : nodes)
+			total += sizeof(Node) + node.bits.bytes();
+		return total;
+	}
+};
+
+
+// FM-index
+// Compressed full-text index: the Burrows-Wheeler transform of the text in
+// a Huffman-shaped wavelet tree, plus the suffix array sampled at every
+// sampleRate-th text position. count() is a backward search, two rank
+// queries per pattern byte, and never touches the text. locate() walks LF
+// steps from each matching row to the nearest sample, at most sampleRate - 1
+// steps per occurrence, so the sample rate trades space for locate speed.
+//
+// Size is about H0(text) bits per byte for the BWT (0.5-0.6n for English
+// text), 1 bit per byte to mark the sampled rows and 4 / sampleRate bytes
+// per byte for the samples. The suffix array is only needed while building.
+// With ignoreCase the index is built over the case-folded text.
+class FMIndex {
+protected:
+	const char* source = nullptr;
+	int size = 0;
+	bool folded = false;
+	int sampleRate = 32;
+	// The BWT has size + 1 rows; row 0 is the empty suffix (the sentinel).
+	// The sentinel's own BWT entry sits in row primary and is stored in the
+	// wavelet tree as the placeholder byte, occ() takes it back out.
+	int primary = 0;
+	unsigned char placeholder = 0;
+	// Rows whose suffix starts with a byte smaller than c
+	int64_t C[257] = {};
+	WaveletTree bwt;
+	RankBitVector sampled;
+	vector<int> samples;
+
+
+	unsigned char fold(unsigned char c) const {
+		return (folded && c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+	}
+
+
+	// Occurrences of c in the BWT rows [0, row)
+	size_t occ(unsigned char c, size_t row) const {
+		size_t r = bwt.rank(c, row);
+		if (c == placeholder && row > (size_t)primary) r--;
+		return r;
+	}
+
+
+	// Text position of the suffix in a row, by LF steps to a sampled row
+	int position(size_t row) const {
+		int steps = 0;
+		while (!sampled.get(row)) {
+			size_t rank;
+			unsigned char c = bwt.access(row, rank);
+			if (c == placeholder && row > (size_t)primary) rank--;
+			row = C[c] + rank;
+			steps++;
+		}
+		return samples[sampled.rank1(row)] + steps;
+	}
+
+public:
+	FMIndex() {}
+
+
+	FMIndex(const char* text, int length, bool ignoreCase = false, int sampleRate = 32, int threads = 1) {
+		source = text;
+		size = length;
+		folded = ignoreCase;
+		this->sampleRate = max(1, sampleRate);
+
+		vector<int> sa = SuffixArray::suffixOrder(text, length, ignoreCase, threads);
+
+		// Row r > 0 holds the suffix sa[r - 1]; its BWT byte precedes it
+		vector<unsigned char> last(size + 1);
+		sampled = RankBitVector(size + 1);
+		last[0] = size > 0 ? fold(text[size - 1]) : 0;
+		if (size % this->sampleRate == 0) sampled.set(0);
+		for (int r = 1; r <= size; r++) {
+			int at = sa[r - 1];
+			if (at == 0) primary = r;
+			else last[r] = fold(text[at - 1]);
+			if (at % this->sampleRate == 0) sampled.set(r);
+		}
+		placeholder = last[0];
+		last[primary] = placeholder;
+		sampled.finish();
+
+		samples.reserve(size / this->sampleRate + 1);
+		if (size % this->sampleRate == 0) samples.push_back(size);
+		for (int r = 1; r <= size; r++) {
+			if (sa[r - 1] % this->sampleRate == 0) samples.push_back(sa[r - 1]);
+		}
+
+		// C[c] counts the sentinel row, then every byte below c
+		int64_t counts[256] = {};
+		for (int i = 0; i < size; i++)
+			counts[fold(text[i])]++;
+		C[0] = 1;
+		for (int c = 0; c < 256; c++)
+			C[c + 1] = C[c] + counts[c];
+
+		sa = vector<int>();
+		bwt = WaveletTree(last);
+	}
+
+
+	const char* text() const { return source; }
+
+
+	bool ignoresCase() const { return folded; }
+
+
+	int samplingRate() const { return sampleRate; }
+
+
+	// BWT rows [first, last) whose suffixes start with the pattern
+	pair<int, int> range(const string& pattern) const {
+		if (pattern.empty()) return { 0, 0 };
+		size_t first = 0, last = size + 1;
+		for (int k = pattern.length() - 1; k >= 0 && first < last; k--) {
+			unsigned char c = fold(pattern[k]);
+			first = C[c] + occ(c, first);
+			last = C[c] + occ(c, last);
+		}
+		if (first >= last) return { 0, 0 };
+		return { int(first), int(last) };
+	}
+
+
+	int count(const string& pattern) const {
+		pair<int, int> r = range(pattern);
+		return r.second - r.first;
+	}
+
+
+	// Start offsets of every occurrence, ascending
+	vector<int> locate(const string& pattern) const {
+		pair<int, int> r = range(pattern);
+		vector<int> found_in;
+		found_in.reserve(r.second - r.first);
+		for (int row = r.first; row < r.second; row++)
+			found_in.push_back(position(row));
+		sort(found_in.begin(), found_in.end());
+		return found_in;
+	}
+
+
+	size_t bytes() const {
+		return sizeof(*this) + bwt.bytes() + sampled.bytes() + samples.size() * sizeof(int);
+	}
+};
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "List_Intersection.h"
+
+using namespace std;
+
+
+// n distinct ids below range, sorted
+template <class T>
+vector<T> randomList(size_t n, uint32_t range, mt19937& random) {
+	vector<char> taken(range, 0);
+	vector<T> list;
+	while (list.size() < n) {
+		uint32_t v = random() % range;
+		if (!taken[v]) {
+			taken[v] = 1;
+			list.push_back(v);
+		}
+	}
+	sort(list.begin(), list.end());
+	return list;
+}
+
+
+// Nanoseconds per call, best of a few rounds
+template <class Kernel>
+double timeKernel(Kernel kernel, int repeat) {
+	double best = 1e300;
+	for (int round = 0; round < 5; round++) {
+		auto start = chrono::steady_clock::now();
+		for (int r = 0; r < repeat; r++)
+			kernel();
+		best = min(best, chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / repeat);
+	}
+	return best;
+}
+
+
+template <class T>
+void benchmark(const char* name, size_t large, uint32_t range, int repeat, mt19937& random) {
+	printf("\n%s lists, long list %zu ids below %u (ns per intersection)\n", name, large, range);
+	printf("%6s %8s %8s %14s %10s %10s %10s %10s\n", "ratio", "short", "common", "set_intersect", "merge", "gallop", "blocks", "adaptive");
+	for (size_t ratio : { 1, 2, 4, 8, 16, 32, 64, 128, 1024 }) {
+		size_t small = max<size_t>(1, large / ratio);
+		vector<T> a = randomList<T>(small, range, random), b = randomList<T>(large, range, random);
+		vector<T> out(small);
+		size_t common = 0;
+		auto run = [&](auto kernel) {
+			return timeKernel([&] { common = kernel(); }, repeat);
+		};
+		double library = run([&] { return size_t(set_intersection(a.begin(), a.end(), b.begin(), b.end(), out.begin()) - out.begin()); });
+		double merge = run([&] { return intersectMerge(a.data(), a.size(), b.data(), b.size(), out.data()); });
+		double galloping = run([&] { return intersectGallop(a.data(), a.size(), b.data(), b.size(), out.data()); });
+#ifdef __SSE2__
+		double blocks = run([&] { return intersectBlocks(a.data(), a.size(), b.data(), b.size(), out.data()); });
+#else
+		double blocks = 0;
+#endif
+		double adaptive = run([&] { return intersect(a.data(), a.size(), b.data(), b.size(), out.data()); });
+		printf("%6zu %8zu %8zu %14.0f %10.0f %10.0f %10.0f %10.0f\n", ratio, small, common, library, merge, galloping, blocks, adaptive);
+	}
+}
+
+
+// Usage: intersection_bench [--size n] [--repeat r]
+// Times the List_Intersection kernels against std::set_intersection on
+// random sorted lists, with the short list 1 to 1024 times shorter than
+// the long one: 32-bit ids as in posting lists, then 16-bit ids as in
+// Roaring bitmap arrays (at most 4096 of 65536). "blocks" is 0 in builds
+// without SSE2.
+int main(int argc, char** argv) {
+	size_t size = 100000;
+	int repeat = 100;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--size" && i + 1 < argc) {
+			size = atol(argv[++i]);
+		}
+		else if (arg == "--repeat" && i + 1 < argc) {
+			repeat = atoi(argv[++i]);
+		}
+		else {
+			cerr << "usage: " << argv[0] << " [--size n] [--repeat r]" << endl;
+			return 1;
+		}
+	}
+
+	mt19937 random(1);
+	benchmark<int>("32-bit", size, size * 4, repeat, random);
+	benchmark<uint16_t>("16-bit", 4096, 65536, repeat * 16, random);
+	return 0;
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+#include <cctype>
+#include <cstdio>
+
+using namespace std;
+
+
+// Minimal JSON reader for the project's own data files (js/data.json and
+// JSON-lines corpora). Numbers are read as doubles; unicode escapes outside the
+// ASCII range are encoded back to UTF-8.
+struct JsonValue {
+	enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+	Type type = NUL;
+	bool boolean = false;
+	double number = 0;
+	string str;
+	vector<JsonValue> array;
+	vector<pair<string, JsonValue>> object;
+
+	// Object member lookup, nullptr when absent (or not an object)
+	const JsonValue* get(const string& key) const {
+		for (const auto& member : object) {
+			if (member.first == key)
+				return &member.second;
+		}
+		return nullptr;
+	}
+};
+
+
+class JsonReader {
+protected:
+	const char* s;
+	const char* end;
+
+
+	void skipSpace() {
+		while (s < end && (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r'))
+			s++;
+	}
+
+
+	bool literal(const char* word) {
+		const char* p = s;
+		for (; *word; word++, p++) {
+			if (p == end || *p != *word) return false;
+		}
+		s = p;
+		return true;
+	}
+
+
+	static void appendUtf8(string& out, unsigned code) {
+		if (code < 0x80) {
+			out += char(code);
+		}
+		else if (code < 0x800) {
+			out += char(0xC0 | (code >> 6));
+			out += char(0x80 | (code & 0x3F));
+		}
+		else if (code < 0x10000) {
+			out += char(0xE0 | (code >> 12));
+			out += char(0x80 | ((code >> 6) & 0x3F));
+			out += char(0x80 | (code & 0x3F));
+		}
+		else {
+			out += char(0xF0 | (code >> 18));
+			out += char(0x80 | ((code >> 12) & 0x3F));
+			out += char(0x80 | ((code >> 6) & 0x3F));
+			out += char(0x80 | (code & 0x3F));
+		}
+	}
+
+
+	bool hex4(unsigned& code) {
+		if (end - s < 4) return false;
+		code = 0;
+		for (int i = 0; i < 4; i++) {
+			char c = *s++;
+			code <<= 4;
+			if (c >= '0' && c <= '9') code |= c - '0';
+			else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+			else return false;
+		}
+		return true;
+	}
+
+
+	bool parseString(string& out) {
+		s++;
+		out.clear();
+		while (s < end && *s != '"') {
+			// Copy unescaped runs in one go
+			const char* run = s;
+			while (s < end && *s != '"' && *s != '\\')
+				s++;
+			out.append(run, s - run);
+			if (s == end || *s == '"') break;
+
+			s++;
+			if (s == end) return false;
+			char c = *s++;
+			switch (c) {
+			case 'n': out += '\n'; break;
+			case 't': out += '\t'; break;
+			case 'r': out += '\r'; break;
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'u': {
+				unsigned code;
+				if (!hex4(code)) return false;
+				if (code >= 0xD800 && code < 0xDC00 && end - s >= 6 && s[0] == '\\' && s[1] == 'u') {
+					unsigned low;
+					s += 2;
+					if (!hex4(low)) return false;
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				}
+				appendUtf8(out, code);
+				break;
+			}
+			default: out += c;
+			}
+		}
+		if (s == end) return false;
+		s++;
+		return true;
+	}
+
+
+	bool parseValue(JsonValue& out, int depth) {
+		if (depth > 64) return false;
+		skipSpace();
+		if (s == end) return false;
+
+		switch (*s) {
+		case '{':
+			out.type = JsonValue::OBJECT;
+			s++;
+			skipSpace();
+			if (s < end && *s == '}') { s++; return true; }
+			while (true) {
+				skipSpace();
+				if (s == end || *s != '"') return false;
+				out.object.emplace_back();
+				if (!parseString(out.object.back().first)) return false;
+				skipSpace();
+				if (s == end || *s != ':') return false;
+				s++;
+				if (!parseValue(out.object.back().second, depth + 1)) return false;
+				skipSpace();
+				if (s < end && *s == ',') { s++; continue; }
+				if (s < end && *s == '}') { s++; return true; }
+				return false;
+			}
+		case '[':
+			out.type = JsonValue::ARRAY;
+			s++;
+			skipSpace();
+			if (s < end && *s == ']') { s++; return true; }
+			while (true) {
+				out.array.emplace_back();
+				if (!parseValue(out.array.back(), depth + 1)) return false;
+				skipSpace();
+				if (s < end && *s == ',') { s++; continue; }
+				if (s < end && *s == ']') { s++; return true; }
+				return false;
+			}
+		case '"':
+			out.type = JsonValue::STRING;
+			return parseString(out.str);
+		case 't':
+			out.type = JsonValue::BOOLEAN;
+			out.boolean = true;
+			return literal("true");
+		case 'f':
+			out.type = JsonValue::BOOLEAN;
+			return literal("false");
+		case 'n':
+			return literal("null");
+		default: {
+			string digits;
+			while (s < end && (isdigit((unsigned char)*s) || *s == '-' || *s == '+' || *s == '.' || *s == 'e' || *s == 'E'))
+				digits += *s++;
+			if (digits.empty()) return false;
+			out.type = JsonValue::NUMBER;
+			out.number = strtod(digits.c_str(), nullptr);
+			return true;
+		}
+		}
+	}
+
+public:
+	JsonReader(const char* data, size_t size) {
+		s = data;
+		end = data + size;
+	}
+
+
+	// Parses one complete document; false on malformed input
+	bool parse(JsonValue& out) {
+		out = JsonValue();
+		if (!parseValue(out, 0)) return false;
+		skipSpace();
+		return s == end;
+	}
+};
+
+
+// Quotes and escapes s as a JSON string literal
+inline string jsonString(const string& s) {
+	string out = "\"";
+	for (unsigned char c : s) {
+		switch (c) {
+		case '"': out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\n': out += "\\n"; break;
+		case '\r': out += "\\r"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			if (c < 0x20) {
+				char buf[8];
+				snprintf(buf, sizeof(buf), "\\u%04x", c);
+				out += buf;
+			}
+			else {
+				out += char(c);
+			}
+		}
+	}
+	return out + "\"";
+}
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <cstdio>
+
+#include "Json_Reader.h"
+
+using namespace std;
+
+
+// Lexicon Code Generator
+// Turns the sentiment lexicon (js/data.json) into cpp/Sentiment_Lexicon.h:
+// the keyword table plus a constexpr StaticAhoCorasick sized from the trie
+// counted here. Re-run whenever data.json changes:
+//
+//   g++ -std=c++20 -O2 -o lexicon_codegen cpp/Lexicon_Codegen.cpp
+//   ./lexicon_codegen js/data.json cpp/Sentiment_Lexicon.h
+
+
+struct Keyword {
+	string word;
+	int weight;
+	int category;
+	string suggestion;
+};
+
+
+string lowercase(string s) {
+	for (char& c : s) {
+		if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+	}
+	return s;
+}
+
+
+string quoted(const string& s) {
+	string out = "\"";
+	for (unsigned char c : s) {
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += char(c);
+		}
+		else if (c < 0x20 || c >= 0x7F) {
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\x%02X\"\"", c);
+			out += buf;
+		}
+		else {
+			out += char(c);
+		}
+	}
+	return out + "\"";
+}
+
+
+// Same class assignment and trie shape as the StaticAhoCorasick constructor
+void countAutomaton(const vector<Keyword>& keywords, int& states, int& classes) {
+	int byteClass[256] = {};
+	classes = 1;
+	for (const auto& k : keywords) {
+		for (unsigned char c : k.word) {
+			if (byteClass[c] == 0)
+				byteClass[c] = classes++;
+		}
+	}
+
+	map<pair<int, int>, int> trie;
+	states = 1;
+	for (const auto& k : keywords) {
+		int s = 0;
+		for (unsigned char c : k.word) {
+			auto edge = make_pair(s, byteClass[c]);
+			auto it = trie.find(edge);
+			if (it == trie.end())
+				it = trie.emplace(edge, states++).first;
+			s = it->second;
+		}
+	}
+}
+
+
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		cerr << "usage: " << argv[0] << " <data.json> <output header>" << endl;
+		return 2;
+	}
+
+	ifstream in(argv[1], ios::binary);
+	if (!in) {
+		cerr << "cannot open " << argv[1] << endl;
+		return 1;
+	}
+	stringstream buffer;
+	buffer << in.rdbuf();
+	string json = buffer.str();
+
+	JsonValue root;
+	if (!JsonReader(json.data(), json.size()).parse(root) || root.type != JsonValue::OBJECT) {
+		cerr << argv[1] << ": expected an object of keyword categories" << endl;
+		return 1;
+	}
+
+	// Same defaults as analyzeSentiment() in js/sentiment.js
+	vector<string> categories;
+	vector<Keyword> keywords;
+	for (const auto& category : root.object) {
+		categories.push_back(category.first);
+		for (const auto& item : category.second.array) {
+			const JsonValue* word = item.get("word");
+			const JsonValue* weight = item.get("weight");
+			const JsonValue* suggestion = item.get("suggestion");
+			if (word == nullptr || word->str.empty()) continue;
+
+			Keyword k;
+			k.word = lowercase(word->str);
+			k.weight = (weight != nullptr && weight->number != 0) ? int(weight->number) : 5;
+			k.category = categories.size() - 1;
+			k.suggestion = suggestion != nullptr ? suggestion->str : "";
+			keywords.push_back(k);
+		}
+	}
+	if (keywords.empty()) {
+		cerr << argv[1] << ": no keywords" << endl;
+		return 1;
+	}
+
+	int states, classes;
+	countAutomaton(keywords, states, classes);
+
+	ofstream out(argv[2], ios::binary);
+	if (!out) {
+		cerr << "cannot write " << argv[2] << endl;
+		return 1;
+	}
+
+	out << "// Generated by cpp/Lexicon_Codegen.cpp from " << argv[1] << " - do not edit.\n";
+	out << "#pragma once\n\n";
+	out << "#include \"Aho_Corasick.h\"\n\n\n";
+	out << "namespace SentimentLexicon {\n\n";
+	out << "constexpr int CATEGORIES = " << categories.size() << ";\n";
+	out << "constexpr int KEYWORDS = " << keywords.size() << ";\n";
+	out << "constexpr int STATES = " << states << ";\n";
+	out << "constexpr int CLASSES = " << classes << ";\n\n";
+
+	out << "inline constexpr const char* categories[CATEGORIES] = {\n";
+	for (const auto& c : categories)
+		out << "\t" << quoted(c) << ",\n";
+	out << "};\n\n";
+
+	out << "inline constexpr LexiconEntry entries[KEYWORDS] = {\n";
+	for (const auto& k : keywords)
+		out << "\t{ " << quoted(k.word) << ", " << k.weight << ", " << k.category << ", " << quoted(k.suggestion) << " },\n";
+	out << "};\n\n";
+
+	out << "inline constexpr StaticAhoCorasick<STATES, CLASSES, KEYWORDS> automaton(entries);\n";
+	out << "static_assert(automaton.stateCount() == STATES, \"regenerate Sentiment_Lexicon.h\");\n\n";
+	out << "}\n";
+
+	cout << argv[2] << ": " << categories.size() << " categories, " << keywords.size() << " keywords, "
+		<< states << " states, " << classes << " byte classes" << endl;
+	return 0;
+}
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <charconv>
+#include <cstdio>
+
+#include "Csv_Reader.h"
+#include "Json_Reader.h"
+#include "Snapshot.h"
+
+using namespace std;
+
+
+// Movie Catalog
+// Loads the five movie tables and joins them per movie exactly as
+// loadAllData() and searchMovies() in js/search.js do, including which
+// duplicate wins. The tables come either embedded in js/movie_data.js
+// (MOVIES_CSV, RATINGS_CSV, ...) or as movies.csv, ratings.csv, genres.csv,
+// sequels.csv and actors.csv in one directory.
+//
+// The files are memory mapped and parsed in place by CsvReader. The
+// catalog is columnar: one contiguous array per attribute, indexed by
+// movie, with the strings of a column packed into one arena. That is also
+// the layout of a snapshot (Snapshot.h), so save() writes the columns as
+// they are and map() uses them straight from the mapped file.
+class MovieCatalog {
+protected:
+	StringColumn ids, titles, releaseDates;
+	Column<double> popularities, voteAverages;
+	Column<int> voteCounts;
+	// Release date as yyyymmdd (missing month or day as 00), 0 when unknown
+	Column<int> releaseDays;
+
+	// Genres of movie i: genreNames[genreStart[genreKey[i]] ..
+	// genreStart[genreKey[i] + 1]), genreKey -1 when it has none
+	Column<int> genreKey, genreStart;
+	StringColumn genreNames;
+
+	// Cast of movie i: actorNames[actorStart[actorRow[i]] .. ], -1 for none
+	Column<int> actorRow, actorStart;
+	StringColumn actorNames;
+
+	// SEQUELS_CSV entry of movie i (-1 for none) and its sequel's entry
+	Column<int> sequelRow, nextSequelRow;
+	StringColumn sequelTitles, sequelIds;
+
+
+	enum Table { MOVIES, RATINGS, GENRES, SEQUELS, ACTORS };
+
+
+	// The body of `const NAME = `...`;` inside a mapped script
+	static bool embeddedTable(string_view js, const string& name, string_view& csv) {
+		size_t at = js.find("const " + name + " = `");
+		if (at == string_view::npos) return false;
+		size_t start = js.find('`', at) + 1;
+		size_t end = js.find('`', start);
+		if (end == string_view::npos) return false;
+		csv = js.substr(start, end - start);
+		return true;
+	}
+
+
+	// parseFloat(s) || 0 and parseInt(s) || 0
+	static double number(string_view s) {
+		double value = 0;
+		from_chars(s.data(), s.data() + s.size(), value);
+		return value == value ? value : 0;
+	}
+
+	static int integer(string_view s) {
+		int value = 0;
+		from_chars(s.data(), s.data() + s.size(), value);
+		return value;
+	}
+
+
+	// Last row of each key, as the JS lookup objects keep it
+	static unordered_map<string_view, int> lastRow(const CsvTable& table, string_view key) {
+		unordered_map<string_view, int> rows;
+		int column = table.column(key);
+		for (int r = 0; r < table.rows; r++)
+			rows[table.field(column, r)] = r;
+		return rows;
+	}
+
+
+	void join(const CsvTable* tables) {
+		const CsvTable& movies = tables[MOVIES];
+		int n = movies.rows;
+		int idColumn = movies.column("id");
+		int titleColumn = movies.column("title");
+		int popularityColumn = movies.column("popularity");
+		int dateColumn = movies.column("release_date");
+
+		vector<string_view> idViews(n), titleViews(n), dateViews(n);
+		vector<double> popularity(n);
+		vector<int> days(n);
+		for (int i = 0; i < n; i++) {
+			idViews[i] = movies.field(idColumn, i);
+			titleViews[i] = movies.field(titleColumn, i);
+			popularity[i] = number(movies.field(popularityColumn, i));
+			string_view date = movies.field(dateColumn, i);
+			dateViews[i] = date.empty() ? "Unknown" : date;
+			days[i] = parseDay(date);
+		}
+
+		const CsvTable& ratings = tables[RATINGS];
+		auto ratingRows = lastRow(ratings, "id");
+		int averageColumn = ratings.column("vote_average");
+		int countColumn = ratings.column("vote_count");
+		vector<double> average(n, 0);
+		vector<int> votes(n, 0);
+		for (int i = 0; i < n; i++) {
+			auto r = ratingRows.find(idViews[i]);
+			if (r == ratingRows.end()) continue;
+			average[i] = number(ratings.field(averageColumn, r->second));
+			votes[i] = integer(ratings.field(countColumn, r->second));
+		}
+
+		// Genres keep their row order per movie id (a counting sort by key)
+		const CsvTable& genres = tables[GENRES];
+		int movieIdColumn = genres.column("movie_id");
+		int genreColumn = genres.column("genre");
+		unordered_map<string_view, int> keys;
+		vector<int> rowKey(genres.rows);
+		for (int r = 0; r < genres.rows; r++)
+			rowKey[r] = keys.emplace(genres.field(movieIdColumn, r), keys.size()).first->second;
+		vector<int> starts(keys.size() + 1, 0);
+		for (int key : rowKey)
+			starts[key + 1]++;
+		for (size_t k = 1; k < starts.size(); k++)
+			starts[k] += starts[k - 1];
+		vector<string_view> names(genres.rows);
+		vector<int> cursor(starts.begin(), starts.end() - 1);
+		for (int r = 0; r < genres.rows; r++)
+			names[cursor[rowKey[r]]++] = genres.field(genreColumn, r);
+		vector<int> movieKey(n, -1);
+		for (int i = 0; i < n; i++) {
+			auto k = keys.find(idViews[i]);
+			if (k != keys.end()) movieKey[i] = k->second;
+		}
+		genreKey = Column<int>(move(movieKey));
+		genreStart = Column<int>(move(starts));
+		genreNames = StringColumn(names);
+
+		const CsvTable& sequels = tables[SEQUELS];
+		auto sequelRows = lastRow(sequels, "id");
+		int sequelTitleColumn = sequels.column("title");
+		int sequelColumn = sequels.column("sequel");
+		vector<int> entry(n, -1), nextEntry(n, -1);
+		for (int i = 0; i < n; i++) {
+			auto r = sequelRows.find(idViews[i]);
+			if (r == sequelRows.end()) continue;
+			entry[i] = r->second;
+			string_view next = sequels.field(sequelColumn, r->second);
+			auto nr = sequelRows.find(next);
+			if (!next.empty() && nr != sequelRows.end()) nextEntry[i] = nr->second;
+		}
+		vector<string_view> entryTitles(sequels.rows), entryIds(sequels.rows);
+		for (int r = 0; r < sequels.rows; r++) {
+			entryTitles[r] = sequels.field(sequelTitleColumn, r);
+			entryIds[r] = sequels.field(sequelColumn, r);
+		}
+		sequelRow = Column<int>(move(entry));
+		nextSequelRow = Column<int>(move(nextEntry));
+		sequelTitles = StringColumn(entryTitles);
+		sequelIds = StringColumn(entryIds);
+
+		// Actor lists look like [a,b,c]; the names are split in place
+		const CsvTable& actors = tables[ACTORS];
+		int actorColumn = actors.column("Actor");
+		auto actorRows = lastRow(actors, "Title");
+		vector<int> castStart(actors.rows + 1, 0);
+		names.clear();
+		for (int r = 0; r < actors.rows; r++) {
+			string_view list = actors.field(actorColumn, r);
+			if (!list.empty() && list.front() == '[') list.remove_prefix(1);
+			if (!list.empty() && list.back() == ']') list.remove_suffix(1);
+			while (true) {
+				size_t comma = list.find(',');
+				string_view name = list.substr(0, comma);
+				size_t first = name.find_first_not_of(" \t\r\n\v\f");
+				name = first == string_view::npos ? string_view() : name.substr(first, name.find_last_not_of(" \t\r\n\v\f") - first + 1);
+				if (!name.empty()) names.push_back(name);
+				if (comma == string_view::npos) break;
+				list.remove_prefix(comma + 1);
+			}
+			castStart[r + 1] = names.size();
+		}
+		vector<int> cast(n, -1);
+		for (int i = 0; i < n; i++) {
+			auto r = actorRows.find(titleViews[i]);
+			if (r != actorRows.end()) cast[i] = r->second;
+		}
+		actorRow = Column<int>(move(cast));
+		actorStart = Column<int>(move(castStart));
+		actorNames = StringColumn(names);
+
+		ids = StringColumn(idViews);
+		titles = StringColumn(titleViews);
+		releaseDates = StringColumn(dateViews);
+		popularities = Column<double>(move(popularity));
+		releaseDays = Column<int>(move(days));
+		voteAverages = Column<double>(move(average));
+		voteCounts = Column<int>(move(votes));
+	}
+
+public:
+	// "2009-12-10" -> 20091210, "2009" -> 20090000, anything else 0
+	static int parseDay(string_view date) {
+		static const int widths[3] = { 4, 2, 2 };
+		int value = 0, scale = 10000;
+		size_t at = 0;
+		for (int p = 0; p < 3; p++) {
+			int part = 0;
+			for (int k = 0; k < widths[p]; k++, at++) {
+				if (at >= date.size() || date[at] < '0' || date[at] > '9')
+					return p == 0 ? 0 : value;
+				part = part * 10 + (date[at] - '0');
+			}
+			value += part * scale;
+			scale /= 100;
+			if (at == date.size() || date[at] != '-') break;
+			at++;
+		}
+		return value;
+	}
+
+
+	// Loads js/movie_data.js, or a directory of CSV files; false when the
+	// movie table is missing
+	bool load(const string& path) {
+		static const char* embedded[5] = { "MOVIES_CSV", "RATINGS_CSV", "GENRES_CSV", "SEQUELS_CSV", "ACTORS_CSV" };
+		static const char* fileNames[5] = { "movies.csv", "ratings.csv", "genres.csv", "sequels.csv", "actors.csv" };
+
+		MappedFile files[5];
+		CsvTable tables[5];
+		bool script = path.size() > 3 && path.compare(path.size() - 3, 3, ".js") == 0;
+		if (script) {
+			if (!files[0].open(path)) return false;
+			for (int t = 0; t < 5; t++) {
+				string_view csv;
+				if (embeddedTable(files[0].view(), embedded[t], csv))
+					CsvReader(csv).parse(tables[t]);
+				else if (t == MOVIES)
+					return false;
+			}
+		}
+		else {
+			for (int t = 0; t < 5; t++) {
+				if (files[t].open(path + "/" + fileNames[t]))
+					CsvReader(files[t].view()).parse(tables[t]);
+				else if (t == MOVIES)
+					return false;
+			}
+		}
+
+		join(tables);
+		return true;
+	}
+
+
+	void save(SnapshotWriter& out) const {
+		ids.save(out);
+		titles.save(out);
+		releaseDates.save(out);
+		out.write(popularities);
+		out.write(voteAverages);
+		out.write(voteCounts);
+		out.write(releaseDays);
+		out.write(genreKey);
+		out.write(genreStart);
+		genreNames.save(out);
+		out.write(actorRow);
+		out.write(actorStart);
+		actorNames.save(out);
+		out.write(sequelRow);
+		out.write(nextSequelRow);
+		sequelTitles.save(out);
+		sequelIds.save(out);
+	}
+
+
+	// Uses the columns of a snapshot in place; the reader must outlive the
+	// catalog. False when the snapshot is truncated or inconsistent.
+	bool map(SnapshotReader& in) {
+		ids.map(in);
+		titles.map(in);
+		releaseDates.map(in);
+		in.read(popularities);
+		in.read(voteAverages);
+		in.read(voteCounts);
+		in.read(releaseDays);
+		in.read(genreKey);
+		in.read(genreStart);
+		genreNames.map(in);
+		in.read(actorRow);
+		in.read(actorStart);
+		actorNames.map(in);
+		in.read(sequelRow);
+		in.read(nextSequelRow);
+		sequelTitles.map(in);
+		sequelIds.map(in);
+
+		size_t n = ids.size();
+		bool sized = titles.size() == n && releaseDates.size() == n && popularities.size() == n
+			&& voteAverages.size() == n && voteCounts.size() == n && releaseDays.size() == n && genreKey.size() == n
+			&& actorRow.size() == n && sequelRow.size() == n && nextSequelRow.size() == n
+			&& sequelIds.size() == sequelTitles.size();
+		// Every row and offset must land inside the column it indexes
+		int sequels = sequelTitles.size();
+		bool valid = sized && genreStart.partitions(genreNames.size()) && actorStart.partitions(actorNames.size())
+			&& genreKey.within(-1, int(genreStart.size()) - 2) && actorRow.within(-1, int(actorStart.size()) - 2)
+			&& sequelRow.within(-1, sequels - 1) && nextSequelRow.within(-1, sequels - 1);
+		if (!valid) in.fail();
+		return in.good();
+	}
+
+
+	int size() const { return ids.size(); }
+
+
+	string_view id(int i) const { return ids[i]; }
+
+
+	string_view title(int i) const { return titles[i]; }
+
+
+	double popularity(int i) const { return popularities[i]; }
+
+
+	string_view releaseDate(int i) const { return releaseDates[i]; }
+
+
+	double voteAverage(int i) const { return voteAverages[i]; }
+
+
+	int voteCount(int i) const { return voteCounts[i]; }
+
+
+	// yyyymmdd, 0 when the date is unknown
+	int releaseDay(int i) const { return releaseDays[i]; }
+
+
+	// GENRES_CSV entries of movie i, in file order
+	vector<string_view> genres(int i) const {
+		vector<string_view> names;
+		if (genreKey[i] >= 0) {
+			for (int g = genreStart[genreKey[i]]; g < genreStart[genreKey[i] + 1]; g++)
+				names.push_back(genreNames[g]);
+		}
+		return names;
+	}
+
+
+	// Cast of movie i, in file order
+	vector<string_view> actors(int i) const {
+		vector<string_view> names;
+		if (actorRow[i] >= 0) {
+			for (int a = actorStart[actorRow[i]]; a < actorStart[actorRow[i] + 1]; a++)
+				names.push_back(actorNames[a]);
+		}
+		return names;
+	}
+
+
+	// The movieInfo object of searchMovies()
+	string toJson(int i) const {
+		auto text = [](string_view v) { return jsonString(string(v)); };
+		// Shortest form that reads back as the same double, as JS prints it
+		auto number = [](double v) {
+			char value[32];
+			return string(value, to_chars(value, value + sizeof(value), v).ptr);
+		};
+		string out = "{\"id\":" + text(ids[i]);
+		out += ",\"title\":" + text(titles[i]);
+		out += ",\"popularity\":" + number(popularities[i]);
+		out += ",\"release_date\":" + text(releaseDates[i]);
+		out += ",\"rating\":{\"vote_average\":" + number(voteAverages[i]) + ",\"vote_count\":" + to_string(voteCounts[i]) + "}";
+
+		out += ",\"genres\":[";
+		if (genreKey[i] >= 0) {
+			for (int g = genreStart[genreKey[i]]; g < genreStart[genreKey[i] + 1]; g++)
+				out += (g > genreStart[genreKey[i]] ? "," : "") + text(genreNames[g]);
+		}
+		out += "],\"sequel\":";
+		if (sequelRow[i] >= 0) {
+			string_view next = sequelIds[sequelRow[i]];
+			out += "{\"title\":" + text(sequelTitles[sequelRow[i]]) + ",\"sequel\":";
+			out += (next.empty() ? string("null") : text(next)) + "}";
+		}
+		else out += "null";
+
+		out += ",\"actors\":[";
+		if (actorRow[i] >= 0) {
+			for (int a = actorStart[actorRow[i]]; a < actorStart[actorRow[i] + 1]; a++)
+				out += (a > actorStart[actorRow[i]] ? "," : "") + text(actorNames[a]);
+		}
+		out += "]";
+		if (nextSequelRow[i] >= 0 && !sequelTitles[nextSequelRow[i]].empty())
+			out += ",\"sequelTitle\":" + text(sequelTitles[nextSequelRow[i]]);
+		return out + "}";
+	}
+};
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+
+#include "Movie_Catalog.h"
+#include "Movie_Search.h"
+
+using namespace std;
+
+
+string resultJson(const MovieCatalog& catalog, const string& query, const vector<int>& found, double milliseconds) {
+	char time[32];
+	snprintf(time, sizeof(time), "%.3f", milliseconds);
+	string out = "{\"query\":" + jsonString(query) + ",\"count\":" + to_string(found.size());
+	out += ",\"searchTime\":\"" + string(time) + "\",\"results\":[";
+	for (size_t i = 0; i < found.size(); i++)
+		out += (i > 0 ? "," : "") + catalog.toJson(found[i]);
+	return out + "]}";
+}
+
+
+// Usage: movie_search [--data js/movie_data.js] [--save-snapshot file]
+//                     [--limit k] [--suggest | --fuzzy | --ranked]
+//                     [--genre name]...
+//                     [--from year] [--to year] [--min-rating band]
+//                     [--min-popularity x] [--max-popularity x]
+//                     [--min-vote-average x] [--max-vote-average x]
+//                     [--min-votes n] [--max-votes n]
+//                     [--released-from yyyy-mm-dd] [--released-to yyyy-mm-dd]
+//                     [query]
+// Prints the movies whose title contains the query (case-insensitive), most
+// popular first, as JSON; with --limit only the k most popular. --suggest
+// treats queries as title prefixes and prints the suggestions instead
+// (at most 10 unless --limit says fewer). --fuzzy matches the query words
+// against title words allowing typos (MovieSearch::searchFuzzy). --ranked
+// orders the movies matching any query word in their title or cast by
+// BM25 score (MovieSearch::searchRanked). The remaining options restrict
+// a title search (MovieFilter); with them an empty query lists every
+// movie that passes. Without a query every line of standard input is
+// one query and gets one JSON line. --data also takes a directory of CSV
+// files or a snapshot written by --save-snapshot, which is mapped as is.
+int main(int argc, char** argv) {
+	string data = "js/movie_data.js";
+	string snapshotPath;
+	int limit = INT_MAX;
+	bool suggest = false;
+	bool fuzzy = false;
+	bool ranked = false;
+	MovieFilter filter;
+	string query;
+	bool hasQuery = false;
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--data" && i + 1 < argc) {
+			data = argv[++i];
+		}
+		else if (arg == "--save-snapshot" && i + 1 < argc) {
+			snapshotPath = argv[++i];
+		}
+		else if (arg == "--limit" && i + 1 < argc) {
+			limit = atoi(argv[++i]);
+		}
+		else if (arg == "--suggest") {
+			suggest = true;
+		}
+		else if (arg == "--fuzzy") {
+			fuzzy = true;
+		}
+		else if (arg == "--ranked") {
+			ranked = true;
+		}
+		else if (arg == "--genre" && i + 1 < argc) {
+			filter.genres.push_back(argv[++i]);
+		}
+		else if (arg == "--from" && i + 1 < argc) {
+			filter.minYear = atoi(argv[++i]);
+		}
+		else if (arg == "--to" && i + 1 < argc) {
+			filter.maxYear = atoi(argv[++i]);
+		}
+		else if (arg == "--min-rating" && i + 1 < argc) {
+			filter.minRating = atoi(argv[++i]);
+		}
+		else if (arg == "--min-popularity" && i + 1 < argc) {
+			filter.minPopularity = atof(argv[++i]);
+		}
+		else if (arg == "--max-popularity" && i + 1 < argc) {
+			filter.maxPopularity = atof(argv[++i]);
+		}
+		else if (arg == "--min-vote-average" && i + 1 < argc) {
+			filter.minVoteAverage = atof(argv[++i]);
+		}
+		else if (arg == "--max-vote-average" && i + 1 < argc) {
+			filter.maxVoteAverage = atof(argv[++i]);
+		}
+		else if (arg == "--min-votes" && i + 1 < argc) {
+			filter.minVoteCount = atoi(argv[++i]);
+		}
+		else if (arg == "--max-votes" && i + 1 < argc) {
+			filter.maxVoteCount = atoi(argv[++i]);
+		}
+		else if (arg == "--released-from" && i + 1 < argc) {
+			filter.releasedFrom = MovieCatalog::parseDay(argv[++i]);
+		}
+		else if (arg == "--released-to" && i + 1 < argc) {
+			// A bare year or month covers all of it
+			string to = argv[++i];
+			filter.releasedTo = MovieCatalog::parseDay(to) + (to.size() <= 4 ? 1231 : to.size() <= 7 ? 31 : 0);
+		}
+		else {
+			query = arg;
+			hasQuery = true;
+		}
+	}
+
+	SnapshotReader snapshot;
+	MovieCatalog catalog;
+	bool mapped = snapshot.open(data);
+	if (mapped ? !catalog.map(snapshot) : !catalog.load(data)) {
+		cerr << "cannot load movie data from " << data << endl;
+		return 1;
+	}
+	MovieSearch engine = mapped ? MovieSearch(catalog, snapshot) : MovieSearch(catalog);
+	if (!snapshot.good() && mapped) {
+		cerr << "corrupt snapshot " << data << endl;
+		return 1;
+	}
+
+	if (!snapshotPath.empty()) {
+		if (!engine.save(snapshotPath)) {
+			cerr << "cannot write snapshot " << snapshotPath << endl;
+			return 1;
+		}
+		if (!hasQuery) return 0;
+	}
+
+	auto run = [&](const string& q) {
+		auto start = chrono::steady_clock::now();
+		vector<int> found = suggest ? engine.suggest(q, min(limit, 10))
+			: fuzzy ? engine.searchFuzzy(q, limit)
+			: ranked ? engine.searchRanked(q, limit)
+			: engine.search(q, filter, limit);
+		double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		cout << resultJson(catalog, q, found, elapsed) << '\n';
+	};
+
+	if (hasQuery) {
+		run(query);
+		return 0;
+	}
+
+	string line;
+	while (getline(cin, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.find_first_not_of(" \t") == string::npos) continue;
+		run(line);
+	}
+	return 0;
+}
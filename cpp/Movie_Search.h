@@ -0,0 +1,1379 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <climits>
+#include <tuple>
+
+#include "String_Matching.h"
+#include "Movie_Catalog.h"
+#include "Snapshot.h"
+#include "Roaring_Bitmap.h"
+#include "Range_Filter.h"
+#include "Stream_VByte.h"
+#include "List_Intersection.h"
+
+using namespace std;
+
+
+// Trigram Index
+// Inverted index from every case-folded 3-byte substring to the sorted ids
+// of the documents containing it, stored as one flat posting array with
+// per-trigram offsets (CSR). A document containing a query contains all of
+// the query's trigrams, so intersecting their postings gives a (small)
+// superset of the matches without looking at the other documents.
+class TrigramIndex {
+protected:
+	Column<uint32_t> keys;
+	// Postings of keys[k] are postings[starts[k] .. starts[k + 1])
+	Column<int> starts;
+	Column<int> postings;
+
+
+	static uint32_t trigram(const char* p) {
+		return uint32_t(FOLD_CASE[(unsigned char)p[0]]) << 16
+			| uint32_t(FOLD_CASE[(unsigned char)p[1]]) << 8
+			| FOLD_CASE[(unsigned char)p[2]];
+	}
+
+
+	// Postings of every trigram of the query, shortest first and without
+	// repeats; false when the query is too short, empty when some trigram
+	// does not occur at all
+	bool queryLists(const string& query, vector<pair<const int*, const int*>>& lists) const {
+		lists.clear();
+		if ((int)query.length() < GRAM) return false;
+		for (int i = 0; i + GRAM <= (int)query.length(); i++) {
+			auto list = find(query.data() + i);
+			if (list.first == list.second) {
+				lists.clear();
+				return true;
+			}
+			lists.push_back(list);
+		}
+		sort(lists.begin(), lists.end(), [](const pair<const int*, const int*>& a, const pair<const int*, const int*>& b) {
+			return a.second - a.first != b.second - b.first ? a.second - a.first < b.second - b.first : a.first < b.first;
+		});
+		lists.erase(unique(lists.begin(), lists.end()), lists.end());
+		return true;
+	}
+
+public:
+	static const int GRAM = 3;
+
+
+	TrigramIndex() : starts(vector<int>(1, 0)) {}
+
+
+	TrigramIndex(const vector<string_view>& documents) {
+		vector<pair<uint32_t, int>> pairs;
+		vector<uint32_t> grams;
+		for (int d = 0; d < (int)documents.size(); d++) {
+			string_view doc = documents[d];
+			grams.clear();
+			for (int i = 0; i + GRAM <= (int)doc.length(); i++)
+				grams.push_back(trigram(doc.data() + i));
+			sort(grams.begin(), grams.end());
+			grams.erase(unique(grams.begin(), grams.end()), grams.end());
+			for (uint32_t g : grams)
+				pairs.push_back({ g, d });
+		}
+		sort(pairs.begin(), pairs.end());
+
+		vector<uint32_t> distinct;
+		vector<int> offsets, documentIds;
+		documentIds.reserve(pairs.size());
+		for (size_t i = 0; i < pairs.size(); i++) {
+			if (i == 0 || pairs[i].first != pairs[i - 1].first) {
+				distinct.push_back(pairs[i].first);
+				offsets.push_back(i);
+			}
+			documentIds.push_back(pairs[i].second);
+		}
+		offsets.push_back(documentIds.size());
+		keys = Column<uint32_t>(move(distinct));
+		starts = Column<int>(move(offsets));
+		postings = Column<int>(move(documentIds));
+	}
+
+
+	// Postings of one trigram as [first, last)
+	pair<const int*, const int*> find(const char* gram) const {
+		auto at = lower_bound(keys.begin(), keys.end(), trigram(gram));
+		if (at == keys.end() || *at != trigram(gram))
+			return { nullptr, nullptr };
+		size_t k = at - keys.begin();
+		return { postings.data() + starts[k], postings.data() + starts[k + 1] };
+	}
+
+
+	// Documents holding every trigram of the query. False when the query is
+	// shorter than a trigram and cannot be filtered.
+	bool candidates(const string& query, vector<int>& found) const {
+		found.clear();
+		vector<pair<const int*, const int*>> lists;
+		if (!queryLists(query, lists)) return false;
+		if (lists.empty()) return true;
+
+		// Shortest list first keeps every intermediate result small
+		found.assign(lists[0].first, lists[0].second);
+		vector<int> next(found.size());
+		for (size_t k = 1; k < lists.size() && !found.empty(); k++) {
+			next.resize(intersect(found.data(), found.size(), lists[k].first, lists[k].second - lists[k].first, next.data()));
+			found.swap(next);
+			next.resize(found.size());
+		}
+		return true;
+	}
+
+
+	// The same candidates, produced lazily in increasing id order: each id
+	// of the shortest list is looked up in the others by galloping forward,
+	// and visit(id) returning false stops the scan. False when the query is
+	// shorter than a trigram.
+	template <class Visit>
+	bool scanCandidates(const string& query, Visit visit) const {
+		vector<pair<const int*, const int*>> lists;
+		if (!queryLists(query, lists)) return false;
+		if (lists.empty()) return true;
+
+		for (const int* p = lists[0].first; p != lists[0].second; p++) {
+			bool everywhere = true;
+			for (size_t k = 1; k < lists.size() && everywhere; k++) {
+				lists[k].first = gallop(lists[k].first, lists[k].second, *p);
+				if (lists[k].first == lists[k].second) return true;
+				everywhere = *lists[k].first == *p;
+			}
+			if (everywhere && !visit(*p)) break;
+		}
+		return true;
+	}
+
+
+	size_t bytes() const {
+		return keys.bytes() + starts.bytes() + postings.bytes();
+	}
+
+
+	void save(SnapshotWriter& out) const {
+		out.write(keys);
+		out.write(starts);
+		out.write(postings);
+	}
+
+
+	// Postings must be sorted lists of the given number of documents
+	void map(SnapshotReader& in, int documents) {
+		in.read(keys);
+		in.read(starts);
+		in.read(postings);
+		bool valid = starts.size() == keys.size() + 1 && starts.partitions(postings.size()) && keys.ascending(true)
+			&& postings.within(0, documents - 1) && ascendingRanges(starts, postings);
+		if (!valid) in.fail();
+	}
+};
+
+
+// Title Trie
+// Prefix trie over the case-folded titles for as-you-type suggestions.
+// Every node caches the best-ranked titles below it (up to a fixed count),
+// so a prefix is answered by walking its bytes, O(prefix length), without
+// visiting the subtree. Nodes are numbered in preorder and kept in flat
+// arrays: the edges of node v are childStart[v] .. childStart[v + 1],
+// sorted by label. A node with one child and no title of its own shares
+// its child's cache, so the long single-child chains of title tails cost
+// no extra cache entries.
+class TitleTrie {
+protected:
+	Column<int> childStart;
+	Column<unsigned char> childLabel;
+	Column<int> childNode;
+	// Cache of node v: best[bestStart[v] .. bestEnd[v]), best rank first
+	Column<int> bestStart, bestEnd;
+	Column<int> best;
+	int cached = 0;
+
+
+	struct Builder {
+		const vector<pair<string, int>>& keys;
+		int cached;
+		vector<int> starts, nodes, bestStart, bestEnd, best;
+		vector<unsigned char> labels;
+
+
+		Builder(const vector<pair<string, int>>& keys, int cached) : keys(keys), cached(cached) {}
+
+
+		// Node for keys[lo, hi), which share their first depth bytes
+		int build(size_t lo, size_t hi, size_t depth) {
+			int node = starts.size();
+			starts.push_back(0);
+			bestStart.push_back(0);
+			bestEnd.push_back(0);
+
+			vector<int> ranks;
+			size_t i = lo;
+			for (; i < hi && keys[i].first.size() == depth; i++)
+				ranks.push_back(keys[i].second);
+			vector<size_t> groups;
+			for (size_t j = i; j < hi; j++) {
+				if (j == i || keys[j].first[depth] != keys[j - 1].first[depth])
+					groups.push_back(j);
+			}
+			groups.push_back(hi);
+
+			// Reserving the edges before descending keeps them in node order
+			int edges = labels.size();
+			int children = groups.size() - 1;
+			starts[node] = edges;
+			labels.resize(edges + children);
+			nodes.resize(edges + children);
+			for (int g = 0; g < children; g++) {
+				labels[edges + g] = keys[groups[g]].first[depth];
+				nodes[edges + g] = build(groups[g], groups[g + 1], depth + 1);
+			}
+
+			if (ranks.empty() && children == 1) {
+				bestStart[node] = bestStart[nodes[edges]];
+				bestEnd[node] = bestEnd[nodes[edges]];
+				return node;
+			}
+			for (int g = 0; g < children; g++) {
+				int child = nodes[edges + g];
+				ranks.insert(ranks.end(), best.begin() + bestStart[child], best.begin() + bestEnd[child]);
+			}
+			size_t keep = min(ranks.size(), size_t(cached));
+			partial_sort(ranks.begin(), ranks.begin() + keep, ranks.end());
+			bestStart[node] = best.size();
+			best.insert(best.end(), ranks.begin(), ranks.begin() + keep);
+			bestEnd[node] = best.size();
+			return node;
+		}
+	};
+
+public:
+	TitleTrie() : childStart(vector<int>(2, 0)), bestStart(vector<int>(1, 0)), bestEnd(vector<int>(1, 0)) {}
+
+
+	// Title d has rank d; every node keeps the best `cached` ranks
+	TitleTrie(const vector<string_view>& documents, int cached = 10) : cached(cached) {
+		vector<pair<string, int>> keys(documents.size());
+		for (size_t d = 0; d < documents.size(); d++) {
+			for (char c : documents[d])
+				keys[d].first += FOLD_CASE[(unsigned char)c];
+			keys[d].second = d;
+		}
+		sort(keys.begin(), keys.end());
+
+		Builder builder{ keys, cached };
+		builder.build(0, keys.size(), 0);
+		builder.starts.push_back(builder.labels.size());
+		childStart = Column<int>(move(builder.starts));
+		childLabel = Column<unsigned char>(move(builder.labels));
+		childNode = Column<int>(move(builder.nodes));
+		bestStart = Column<int>(move(builder.bestStart));
+		bestEnd = Column<int>(move(builder.bestEnd));
+		best = Column<int>(move(builder.best));
+	}
+
+
+	// Ranks of the best (at most min(k, cacheSize())) titles starting with
+	// the prefix, case-insensitive, best first
+	vector<int> complete(const string& prefix, int k) const {
+		int node = 0;
+		for (char ch : prefix) {
+			unsigned char c = FOLD_CASE[(unsigned char)ch];
+			const unsigned char* first = childLabel.data() + childStart[node];
+			const unsigned char* last = childLabel.data() + childStart[node + 1];
+			const unsigned char* at = lower_bound(first, last, c);
+			if (at == last || *at != c) return {};
+			node = childNode[at - childLabel.data()];
+		}
+		int n = max(0, min(k, bestEnd[node] - bestStart[node]));
+		return vector<int>(best.data() + bestStart[node], best.data() + bestStart[node] + n);
+	}
+
+
+	int cacheSize() const { return cached; }
+
+
+	int nodeCount() const { return bestStart.size(); }
+
+
+	size_t bytes() const {
+		return childStart.bytes() + childLabel.bytes() + childNode.bytes() + bestStart.bytes() + bestEnd.bytes() + best.bytes();
+	}
+
+
+	void save(SnapshotWriter& out) const {
+		out.write(&cached, 1);
+		out.write(childStart);
+		out.write(childLabel);
+		out.write(childNode);
+		out.write(bestStart);
+		out.write(bestEnd);
+		out.write(best);
+	}
+
+
+	// Cached titles must be ranks of the given number of documents
+	void map(SnapshotReader& in, int documents) {
+		Column<int> size;
+		in.read(size);
+		in.read(childStart);
+		in.read(childLabel);
+		in.read(childNode);
+		in.read(bestStart);
+		in.read(bestEnd);
+		in.read(best);
+		cached = size.empty() ? 0 : size[0];
+		int nodes = bestStart.size();
+		int ranks = best.size();
+		bool valid = size.size() == 1 && cached >= 0 && nodes > 0 && (int)bestEnd.size() == nodes
+			&& (int)childStart.size() == nodes + 1 && childStart.partitions(childLabel.size()) && childNode.size() == childLabel.size()
+			&& ascendingRanges(childStart, childLabel) && childNode.within(0, nodes - 1)
+			&& bestStart.within(0, ranks) && bestEnd.within(0, ranks) && best.within(0, documents - 1);
+		if (!valid) in.fail();
+	}
+};
+
+
+// Deletion Index (SymSpell)
+// Typo-tolerant lookup of title words. A word is a run of letters, digits
+// or non-ASCII bytes, case-folded. Every distinct word is stored together
+// with the hashes of all strings made by deleting up to two of its bytes.
+// Two words within edit distance 2 always share such a deletion (delete
+// the differing bytes from each side), so a query word only needs its own
+// deletions looked up. The hits are a small candidate set, and each
+// candidate is confirmed with MyersMatcher::distance. No dictionary scan
+// and no per-title distance computation is involved. Distances count a
+// swap of two adjacent bytes as one edit, as SymSpell does.
+class DeletionIndex {
+protected:
+	// Distinct words, sorted; titles containing words[w] are
+	// wordTitles[wordStart[w] .. wordStart[w + 1]), ascending
+	StringColumn words;
+	Column<int> wordStart, wordTitles;
+	// Sorted deletion hashes; words with deletion keys[k] are
+	// deletionWords[deletionStart[k] .. deletionStart[k + 1])
+	Column<uint64_t> keys;
+	Column<int> deletionStart, deletionWords;
+
+
+	static bool wordByte(unsigned char c) {
+		return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80;
+	}
+
+
+	// FNV-1a
+	static uint64_t hash(const string& s) {
+		uint64_t h = 14695981039346656037ull;
+		for (unsigned char c : s) {
+			h ^= c;
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+
+	// Hashes of the word and of every deletion of up to `distance` bytes
+	// (with repeats)
+	static void deletions(const string& word, int distance, vector<uint64_t>& out) {
+		out.push_back(hash(word));
+		if (distance == 0) return;
+		string shorter;
+		for (size_t i = 0; i < word.size(); i++) {
+			// Deleting either byte of a repeated pair gives the same string
+			if (i > 0 && word[i] == word[i - 1]) continue;
+			shorter.assign(word, 0, i);
+			shorter.append(word, i + 1, string::npos);
+			deletions(shorter, distance - 1, out);
+		}
+	}
+
+public:
+	static constexpr int MAX_DISTANCE = 2;
+
+
+	// Case-folded words of a text, in order
+	static vector<string> split(string_view text) {
+		vector<string> found;
+		string word;
+		for (char ch : text) {
+			unsigned char c = FOLD_CASE[(unsigned char)ch];
+			if (wordByte(c)) {
+				word += c;
+			}
+			else if (!word.empty()) {
+				found.push_back(word);
+				word.clear();
+			}
+		}
+		if (!word.empty()) found.push_back(word);
+		return found;
+	}
+
+
+	DeletionIndex() : wordStart(vector<int>(1, 0)), deletionStart(vector<int>(1, 0)) {}
+
+
+	// Title d is document d
+	DeletionIndex(const vector<string_view>& documents) {
+		vector<pair<string, int>> occurrences;
+		for (size_t d = 0; d < documents.size(); d++) {
+			for (string& word : split(documents[d]))
+				occurrences.push_back({ move(word), d });
+		}
+		sort(occurrences.begin(), occurrences.end());
+		occurrences.erase(unique(occurrences.begin(), occurrences.end()), occurrences.end());
+
+		vector<string_view> distinct;
+		vector<int> starts, titles;
+		for (size_t i = 0; i < occurrences.size(); i++) {
+			if (i == 0 || occurrences[i].first != occurrences[i - 1].first) {
+				distinct.push_back(occurrences[i].first);
+				starts.push_back(i);
+			}
+			titles.push_back(occurrences[i].second);
+		}
+		starts.push_back(titles.size());
+
+		vector<pair<uint64_t, int>> pairs;
+		vector<uint64_t> hashes;
+		for (size_t w = 0; w < distinct.size(); w++) {
+			hashes.clear();
+			deletions(string(distinct[w]), MAX_DISTANCE, hashes);
+			sort(hashes.begin(), hashes.end());
+			hashes.erase(unique(hashes.begin(), hashes.end()), hashes.end());
+			for (uint64_t h : hashes)
+				pairs.push_back({ h, (int)w });
+		}
+		sort(pairs.begin(), pairs.end());
+		vector<uint64_t> distinctKeys;
+		vector<int> keyStarts, keyWords;
+		for (size_t i = 0; i < pairs.size(); i++) {
+			if (i == 0 || pairs[i].first != pairs[i - 1].first) {
+				distinctKeys.push_back(pairs[i].first);
+				keyStarts.push_back(i);
+			}
+			keyWords.push_back(pairs[i].second);
+		}
+		keyStarts.push_back(keyWords.size());
+
+		words = StringColumn(distinct);
+		wordStart = Column<int>(move(starts));
+		wordTitles = Column<int>(move(titles));
+		keys = Column<uint64_t>(move(distinctKeys));
+		deletionStart = Column<int>(move(keyStarts));
+		deletionWords = Column<int>(move(keyWords));
+	}
+
+
+	// Words within edit distance maxDistance (at most MAX_DISTANCE) of the
+	// case-folded word, as (word id, distance)
+	vector<pair<int, int>> lookup(const string& word, int maxDistance) const {
+		maxDistance = min(maxDistance, MAX_DISTANCE);
+		string folded;
+		for (char c : word)
+			folded += FOLD_CASE[(unsigned char)c];
+
+		vector<uint64_t> hashes;
+		deletions(folded, maxDistance, hashes);
+		sort(hashes.begin(), hashes.end());
+		hashes.erase(unique(hashes.begin(), hashes.end()), hashes.end());
+		vector<int> candidates;
+		for (uint64_t h : hashes) {
+			auto at = lower_bound(keys.begin(), keys.end(), h);
+			if (at == keys.end() || *at != h) continue;
+			size_t k = at - keys.begin();
+			candidates.insert(candidates.end(), deletionWords.begin() + deletionStart[k], deletionWords.begin() + deletionStart[k + 1]);
+		}
+		sort(candidates.begin(), candidates.end());
+		candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+		vector<pair<int, int>> found;
+		MyersMatcher matcher(folded);
+		for (int w : candidates) {
+			int d = matcher.distance(words[w].data(), words[w].size(), maxDistance, true);
+			if (d <= maxDistance)
+				found.push_back({ w, d });
+		}
+		return found;
+	}
+
+
+	string_view word(int w) const { return words[w]; }
+
+
+	// Titles containing word w, ascending
+	pair<const int*, const int*> titles(int w) const {
+		return { wordTitles.data() + wordStart[w], wordTitles.data() + wordStart[w + 1] };
+	}
+
+
+	int wordCount() const { return words.size(); }
+
+
+	size_t bytes() const {
+		return words.bytes() + wordStart.bytes() + wordTitles.bytes() + keys.bytes() + deletionStart.bytes() + deletionWords.bytes();
+	}
+
+
+	void save(SnapshotWriter& out) const {
+		words.save(out);
+		out.write(wordStart);
+		out.write(wordTitles);
+		out.write(keys);
+		out.write(deletionStart);
+		out.write(deletionWords);
+	}
+
+
+	// Title lists must be sorted ranks of the given number of documents
+	void map(SnapshotReader& in, int documents) {
+		words.map(in);
+		in.read(wordStart);
+		in.read(wordTitles);
+		in.read(keys);
+		in.read(deletionStart);
+		in.read(deletionWords);
+		int count = words.size();
+		bool valid = (int)wordStart.size() == count + 1 && wordStart.partitions(wordTitles.size())
+			&& wordTitles.within(0, documents - 1) && ascendingRanges(wordStart, wordTitles)
+			&& deletionStart.size() == keys.size() + 1 && deletionStart.partitions(deletionWords.size())
+			&& keys.ascending(true) && deletionWords.within(0, count - 1);
+		if (!valid) in.fail();
+	}
+};
+
+
+// BM25 Index
+// Ranked retrieval over bags of words: a document scores, for each query
+// term it contains, idf * tf * (K1 + 1) / (tf + K1 * (1 - B + B * len / avg)).
+// Term frequencies come with the documents, so fields can be weighted by
+// counting their words more than once (BM25F with integer weights).
+//
+// Postings are cut into blocks of BLOCK documents. A block keeps its last
+// document and the best score any of its postings reaches, and its
+// document gaps and frequencies are packed with StreamVByte. top() is
+// Block-Max WAND (Ding and Suel): term bounds pick the first document that
+// could still enter the top k, block bounds then rule out whole blocks
+// before they are decoded, so most postings of common terms are never read.
+class Bm25Index {
+protected:
+	static const int BLOCK = 128;
+	static constexpr double K1 = 1.2, B = 0.75;
+	static const uint32_t END = UINT32_MAX;
+
+	// Sorted terms; term t occurs in counts[t] documents, whose postings
+	// are the blocks blockStart[t] .. blockStart[t + 1]
+	StringColumn terms;
+	Column<int> counts, blockStart;
+	// Best score of term t in any document
+	Column<float> termBounds;
+	// Block b: last document, best score and offset of its encoding (the
+	// gaps between its documents, then their frequencies)
+	Column<uint32_t> blockLast, blockOffset;
+	Column<float> blockBounds;
+	Column<uint8_t> encoded;
+	// K1 * (1 - B + B * len / avg) of each document
+	Column<float> norms;
+
+
+	static double idf(double documents, double count) {
+		return log(1 + (documents - count + 0.5) / (count + 0.5));
+	}
+
+
+	double score(double weight, uint32_t tf, uint32_t d) const {
+		return weight * tf * (K1 + 1) / (tf + norms[d]);
+	}
+
+
+	// Bounds are rounded up to floats, so a sum of them is never below the
+	// score it bounds
+	static float upward(double score) {
+		float f = score;
+		return f < score ? nextafterf(f, HUGE_VALF) : f;
+	}
+
+
+	int findTerm(string_view term) const {
+		int low = 0, high = terms.size();
+		while (low < high) {
+			int middle = (low + high) / 2;
+			if (terms[middle] < term) low = middle + 1;
+			else high = middle;
+		}
+		return low < (int)terms.size() && terms[low] == term ? low : -1;
+	}
+
+
+	// Position in the postings of one term. shallow() moves between blocks
+	// by their last documents alone; seek() decodes the block it lands in.
+	struct Cursor {
+		const Bm25Index* index;
+		int term, block, end, decoded = -1, count = 0, position = 0;
+		double weight;
+		float bound;
+		uint32_t current = 0;
+		// Documents of the decoded block, then their frequencies
+		uint32_t values[2 * BLOCK];
+
+		Cursor(const Bm25Index* index, int t) : index(index), term(t), block(index->blockStart[t]), end(index->blockStart[t + 1]),
+			weight(idf(index->norms.size(), index->counts[t])), bound(index->termBounds[t]) {
+			seek(0);
+		}
+
+
+		uint32_t doc() const { return current; }
+
+
+		void shallow(uint32_t target) {
+			while (block < end && index->blockLast[block] < target)
+				block++;
+		}
+
+
+		float blockBound() const { return block < end ? index->blockBounds[block] : 0; }
+
+
+		uint32_t blockEnd() const { return block < end ? index->blockLast[block] : END; }
+
+
+		void decode() {
+			int first = index->blockStart[term];
+			count = block + 1 < end ? BLOCK : index->counts[term] - (end - first - 1) * BLOCK;
+			StreamVByte::decode(index->encoded.data() + index->blockOffset[block], 2 * count, values);
+			uint32_t d = block == first ? 0 : index->blockLast[block - 1];
+			for (int i = 0; i < count; i++) {
+				d += values[i];
+				values[i] = d;
+			}
+			decoded = block;
+			position = 0;
+		}
+
+
+		// First posting at or after target
+		void seek(uint32_t target) {
+			shallow(target);
+			if (block == end) {
+				current = END;
+				return;
+			}
+			if (decoded != block) decode();
+			position = lower_bound(values + position, values + count, target) - values;
+			current = values[position];
+		}
+
+
+		double score() const { return index->score(weight, values[count + position], current); }
+	};
+
+public:
+	Bm25Index() : blockStart(vector<int>(1, 0)) {}
+
+
+	// Document d is documents[d], a list of (term, frequency) with the
+	// frequencies weighted by field; a term may be listed more than once
+	Bm25Index(const vector<vector<pair<string, int>>>& documents) {
+		vector<tuple<string, uint32_t, uint32_t>> postings;
+		vector<double> lengths(documents.size(), 0);
+		double total = 0;
+		for (size_t d = 0; d < documents.size(); d++) {
+			for (const auto& [term, tf] : documents[d]) {
+				postings.push_back({ term, d, tf });
+				lengths[d] += tf;
+			}
+			total += lengths[d];
+		}
+		sort(postings.begin(), postings.end());
+		double average = total > 0 ? total / documents.size() : 1;
+		vector<float> documentNorms(documents.size());
+		for (size_t d = 0; d < documents.size(); d++)
+			documentNorms[d] = K1 * (1 - B + B * lengths[d] / average);
+		norms = Column<float>(move(documentNorms));
+
+		vector<string_view> distinct;
+		vector<int> termCounts, starts(1, 0);
+		vector<float> bounds, lastBounds;
+		vector<uint32_t> lasts, offsets, docs, frequencies, values;
+		vector<uint8_t> bytes;
+		for (size_t i = 0, j = 0; i < postings.size(); i = j) {
+			docs.clear();
+			frequencies.clear();
+			for (; j < postings.size() && get<0>(postings[j]) == get<0>(postings[i]); j++) {
+				auto [term, d, tf] = postings[j];
+				if (!docs.empty() && docs.back() == d) {
+					frequencies.back() += tf;
+				}
+				else {
+					docs.push_back(d);
+					frequencies.push_back(tf);
+				}
+			}
+			distinct.push_back(get<0>(postings[i]));
+			termCounts.push_back(docs.size());
+			double weight = idf(documents.size(), docs.size());
+			float termBound = 0;
+			uint32_t previous = 0;
+			for (size_t first = 0; first < docs.size(); first += BLOCK) {
+				size_t last = min(docs.size(), first + BLOCK);
+				float blockBound = 0;
+				values.clear();
+				for (size_t p = first; p < last; p++) {
+					values.push_back(docs[p] - previous);
+					previous = docs[p];
+					blockBound = max(blockBound, upward(score(weight, frequencies[p], docs[p])));
+				}
+				values.insert(values.end(), frequencies.begin() + first, frequencies.begin() + last);
+				offsets.push_back(bytes.size());
+				StreamVByte::encode(values.data(), values.size(), bytes);
+				lasts.push_back(docs[last - 1]);
+				lastBounds.push_back(blockBound);
+				termBound = max(termBound, blockBound);
+			}
+			bounds.push_back(termBound);
+			starts.push_back(lasts.size());
+		}
+		bytes.resize(bytes.size() + StreamVByte::PADDING, 0);
+
+		terms = StringColumn(distinct);
+		counts = Column<int>(move(termCounts));
+		blockStart = Column<int>(move(starts));
+		termBounds = Column<float>(move(bounds));
+		blockLast = Column<uint32_t>(move(lasts));
+		blockOffset = Column<uint32_t>(move(offsets));
+		blockBounds = Column<float>(move(lastBounds));
+		encoded = Column<uint8_t>(move(bytes));
+	}
+
+
+	// The (at most k) documents scoring highest for the terms, as
+	// (document, score), best first and equal scores by document
+	vector<pair<int, double>> top(vector<string> words, int k) const {
+		vector<pair<int, double>> found;
+		sort(words.begin(), words.end());
+		words.erase(unique(words.begin(), words.end()), words.end());
+		vector<Cursor> cursors;
+		cursors.reserve(words.size());
+		for (const string& word : words) {
+			int t = findTerm(word);
+			if (t >= 0) cursors.emplace_back(this, t);
+		}
+		if (cursors.empty() || k <= 0) return found;
+		vector<Cursor*> order;
+		for (Cursor& cursor : cursors)
+			order.push_back(&cursor);
+		size_t n = order.size();
+
+		// The best k so far as (score, document), the worst on top. Documents
+		// come in increasing order, so a later one needs a higher score.
+		auto better = [](const pair<double, uint32_t>& a, const pair<double, uint32_t>& b) {
+			return a.first != b.first ? a.first > b.first : a.second < b.second;
+		};
+		vector<pair<double, uint32_t>> heap;
+		double threshold = 0;
+		while (true) {
+			// By current document; few cursors, mostly in order already
+			for (size_t i = 1; i < n; i++) {
+				for (size_t j = i; j > 0 && order[j]->doc() < order[j - 1]->doc(); j--)
+					swap(order[j], order[j - 1]);
+			}
+			double bound = 0;
+			size_t p = 0;
+			for (; p < n && order[p]->doc() != END; p++) {
+				bound += order[p]->bound;
+				if (bound > threshold) break;
+			}
+			if (p == n || order[p]->doc() == END) break;
+			uint32_t pivot = order[p]->doc();
+			while (p + 1 < n && order[p + 1]->doc() == pivot)
+				p++;
+
+			double blockBound = 0;
+			for (size_t i = 0; i <= p; i++) {
+				order[i]->shallow(pivot);
+				blockBound += order[i]->blockBound();
+			}
+			if (blockBound > threshold && order[0]->doc() == pivot) {
+				double score = 0;
+				for (size_t i = 0; i <= p; i++)
+					score += order[i]->score();
+				if ((int)heap.size() < k || score > heap.front().first) {
+					if ((int)heap.size() == k) {
+						pop_heap(heap.begin(), heap.end(), better);
+						heap.pop_back();
+					}
+					heap.push_back({ score, pivot });
+					push_heap(heap.begin(), heap.end(), better);
+					if ((int)heap.size() == k) threshold = heap.front().first;
+				}
+				for (size_t i = 0; i <= p; i++)
+					order[i]->seek(pivot + 1);
+			}
+			else if (blockBound > threshold) {
+				// Nothing before the pivot can reach the threshold
+				for (size_t i = 0; order[i]->doc() < pivot; i++)
+					order[i]->seek(pivot);
+			}
+			else {
+				// Nor anything before the end of these blocks
+				uint32_t next = p + 1 < n ? order[p + 1]->doc() : END;
+				for (size_t i = 0; i <= p; i++) {
+					uint32_t last = order[i]->blockEnd();
+					if (last < next) next = last + 1;
+				}
+				for (size_t i = 0; i <= p; i++)
+					order[i]->seek(next);
+			}
+		}
+
+		sort(heap.begin(), heap.end(), better);
+		for (auto [score, d] : heap)
+			found.push_back({ (int)d, score });
+		return found;
+	}
+
+
+	int termCount() const { return terms.size(); }
+
+
+	int blockCount() const { return blockLast.size(); }
+
+
+	size_t bytes() const {
+		return terms.bytes() + counts.bytes() + blockStart.bytes() + termBounds.bytes() + blockLast.bytes()
+			+ blockOffset.bytes() + blockBounds.bytes() + encoded.bytes() + norms.bytes();
+	}
+
+
+	void save(SnapshotWriter& out) const {
+		terms.save(out);
+		out.write(counts);
+		out.write(blockStart);
+		out.write(termBounds);
+		out.write(blockLast);
+		out.write(blockOffset);
+		out.write(blockBounds);
+		out.write(encoded);
+		out.write(norms);
+	}
+
+
+	// Every block is decoded once and must hold sorted documents below
+	// the given count, ending at its recorded last document
+	void map(SnapshotReader& in, int documents) {
+		terms.map(in);
+		in.read(counts);
+		in.read(blockStart);
+		in.read(termBounds);
+		in.read(blockLast);
+		in.read(blockOffset);
+		in.read(blockBounds);
+		in.read(encoded);
+		in.read(norms);
+		if (!in.good()) return;
+		size_t n = terms.size(), blocks = blockLast.size();
+		bool valid = counts.size() == n && termBounds.size() == n && blockStart.size() == n + 1 && blockStart.partitions(blocks)
+			&& blockOffset.size() == blocks && blockBounds.size() == blocks && encoded.size() >= StreamVByte::PADDING
+			&& (int)norms.size() == documents && counts.within(1, documents);
+		for (size_t t = 0; valid && t < n; t++)
+			valid = blockStart[t + 1] - blockStart[t] == (counts[t] + BLOCK - 1) / BLOCK;
+
+		size_t limit = encoded.size() - StreamVByte::PADDING;
+		uint32_t values[2 * BLOCK];
+		for (size_t t = 0; valid && t < n; t++) {
+			int first = blockStart[t], end = blockStart[t + 1];
+			uint64_t d = 0;
+			for (int b = first; valid && b < end; b++) {
+				int count = b + 1 < end ? BLOCK : counts[t] - (end - first - 1) * BLOCK;
+				size_t offset = blockOffset[b];
+				valid = offset + (2 * count + 3) / 4 <= limit && StreamVByte::encodedSize(encoded.data() + offset, 2 * count) <= limit - offset;
+				if (!valid) break;
+				StreamVByte::decode(encoded.data() + offset, 2 * count, values);
+				// Only the first gap of a term may be 0
+				for (int i = 0; valid && i < count; i++) {
+					valid = (values[i] > 0 || (b == first && i == 0)) && d + values[i] < uint64_t(documents);
+					d += values[i];
+				}
+				valid = valid && blockLast[b] == d;
+			}
+		}
+		if (!valid) in.fail();
+	}
+};
+
+
+// Attribute filter of a movie search. Unset fields do not restrict.
+struct MovieFilter {
+	// Every one of these genres is required (exact names from GENRES_CSV)
+	vector<string> genres;
+	// Release year range, inclusive; movies without a date fail any bound
+	int minYear = INT_MIN;
+	int maxYear = INT_MAX;
+	// Lowest rating band: vote_average rounded down, 0-10
+	int minRating = 0;
+	// Inclusive ranges of the numeric columns; release days are yyyymmdd
+	// and, as with years, movies without a date fail any bound
+	double minPopularity = -HUGE_VAL, maxPopularity = HUGE_VAL;
+	double minVoteAverage = -HUGE_VAL, maxVoteAverage = HUGE_VAL;
+	int minVoteCount = INT_MIN, maxVoteCount = INT_MAX;
+	int releasedFrom = INT_MIN, releasedTo = INT_MAX;
+
+
+	bool hasRanges() const {
+		return minPopularity != -HUGE_VAL || maxPopularity != HUGE_VAL
+			|| minVoteAverage != -HUGE_VAL || maxVoteAverage != HUGE_VAL
+			|| minVoteCount != INT_MIN || maxVoteCount != INT_MAX
+			|| releasedFrom != INT_MIN || releasedTo != INT_MAX;
+	}
+
+
+	bool restricts() const {
+		return !genres.empty() || minYear != INT_MIN || maxYear != INT_MAX || minRating > 0 || hasRanges();
+	}
+};
+
+
+// Movie Facets
+// Compressed bitmaps of popularity ranks per genre, per release year and
+// per rating band (vote_average rounded down). A MovieFilter becomes a few
+// bitmap unions and intersections instead of a check per movie. Numeric
+// ranges run over copies of the typed catalog columns in rank order, with
+// the SIMD kernels of Range_Filter.h, and join in as one more bitmap.
+class MovieFacets {
+protected:
+	int movies = 0;
+	// Sorted genre names and release years, with one bitmap each
+	StringColumn genreNames;
+	vector<RoaringBitmap> genreSets;
+	Column<int> years;
+	vector<RoaringBitmap> yearSets;
+	vector<RoaringBitmap> ratingSets;
+	// Value of the movie at each rank
+	Column<double> popularities, voteAverages;
+	Column<int> voteCounts, releaseDays;
+
+
+	// "2009-12-10" -> 2009; INT_MIN when the date has no year
+	static int yearOf(string_view date) {
+		if (date.size() < 4) return INT_MIN;
+		int year = 0;
+		for (int k = 0; k < 4; k++) {
+			if (date[k] < '0' || date[k] > '9') return INT_MIN;
+			year = year * 10 + (date[k] - '0');
+		}
+		return year;
+	}
+
+
+	static RoaringBitmap unite(const vector<RoaringBitmap>& sets, size_t first, size_t last) {
+		vector<const RoaringBitmap*> range;
+		for (size_t k = first; k < last; k++)
+			range.push_back(&sets[k]);
+		return RoaringBitmap::unite(range);
+	}
+
+public:
+	static constexpr int RATING_BANDS = 11;
+
+
+	MovieFacets() {}
+
+
+	MovieFacets(const MovieCatalog& catalog, const Column<int>& byPopularity) : movies(catalog.size()) {
+		vector<pair<string_view, uint32_t>> genreRanks;
+		vector<pair<int, uint32_t>> yearRanks;
+		vector<vector<uint32_t>> bands(RATING_BANDS);
+		vector<double> popularity(movies), average(movies);
+		vector<int> votes(movies), days(movies);
+		for (int rank = 0; rank < movies; rank++) {
+			int movie = byPopularity[rank];
+			popularity[rank] = catalog.popularity(movie);
+			average[rank] = catalog.voteAverage(movie);
+			votes[rank] = catalog.voteCount(movie);
+			days[rank] = catalog.releaseDay(movie);
+			for (string_view genre : catalog.genres(movie))
+				genreRanks.push_back({ genre, rank });
+			int year = yearOf(catalog.releaseDate(movie));
+			if (year != INT_MIN) yearRanks.push_back({ year, rank });
+			int band = min(max((int)floor(catalog.voteAverage(movie)), 0), RATING_BANDS - 1);
+			bands[band].push_back(rank);
+		}
+
+		sort(genreRanks.begin(), genreRanks.end());
+		vector<string_view> names;
+		vector<uint32_t> ranks;
+		for (size_t i = 0; i < genreRanks.size(); i++) {
+			ranks.push_back(genreRanks[i].second);
+			if (i + 1 == genreRanks.size() || genreRanks[i + 1].first != genreRanks[i].first) {
+				names.push_back(genreRanks[i].first);
+				genreSets.push_back(RoaringBitmap(ranks));
+				ranks.clear();
+			}
+		}
+		genreNames = StringColumn(names);
+
+		sort(yearRanks.begin(), yearRanks.end());
+		vector<int> distinctYears;
+		for (size_t i = 0; i < yearRanks.size(); i++) {
+			ranks.push_back(yearRanks[i].second);
+			if (i + 1 == yearRanks.size() || yearRanks[i + 1].first != yearRanks[i].first) {
+				distinctYears.push_back(yearRanks[i].first);
+				yearSets.push_back(RoaringBitmap(ranks));
+				ranks.clear();
+			}
+		}
+		years = Column<int>(move(distinctYears));
+
+		for (auto& band : bands)
+			ratingSets.push_back(RoaringBitmap(band));
+		popularities = Column<double>(move(popularity));
+		voteAverages = Column<double>(move(average));
+		voteCounts = Column<int>(move(votes));
+		releaseDays = Column<int>(move(days));
+	}
+
+
+	// Ranks inside every numeric range of the filter
+	RoaringBitmap selectRanges(const MovieFilter& filter) const {
+		vector<uint64_t> mask = fullMask(movies);
+		if (filter.minPopularity != -HUGE_VAL || filter.maxPopularity != HUGE_VAL)
+			narrowRange(popularities.data(), movies, filter.minPopularity, filter.maxPopularity, mask.data());
+		if (filter.minVoteAverage != -HUGE_VAL || filter.maxVoteAverage != HUGE_VAL)
+			narrowRange(voteAverages.data(), movies, filter.minVoteAverage, filter.maxVoteAverage, mask.data());
+		if (filter.minVoteCount != INT_MIN || filter.maxVoteCount != INT_MAX)
+			narrowRange(voteCounts.data(), movies, filter.minVoteCount, filter.maxVoteCount, mask.data());
+		if (filter.releasedFrom != INT_MIN || filter.releasedTo != INT_MAX)
+			narrowRange(releaseDays.data(), movies, max(filter.releasedFrom, 1), filter.releasedTo, mask.data());
+		return RoaringBitmap::fromMask(mask);
+	}
+
+
+	// Ranks of the movies passing the filter
+	RoaringBitmap select(const MovieFilter& filter) const {
+		vector<RoaringBitmap> parts;
+		for (const string& genre : filter.genres) {
+			size_t g = 0;
+			while (g < genreNames.size() && genreNames[g] < genre) g++;
+			if (g == genreNames.size() || genreNames[g] != genre) return RoaringBitmap();
+			parts.push_back(genreSets[g]);
+		}
+		if (filter.minYear != INT_MIN || filter.maxYear != INT_MAX) {
+			size_t first = lower_bound(years.begin(), years.end(), filter.minYear) - years.begin();
+			size_t last = upper_bound(years.begin(), years.end(), filter.maxYear) - years.begin();
+			parts.push_back(unite(yearSets, first, max(first, last)));
+		}
+		if (filter.minRating > 0)
+			parts.push_back(unite(ratingSets, min(filter.minRating, RATING_BANDS), RATING_BANDS));
+		if (filter.hasRanges())
+			parts.push_back(selectRanges(filter));
+
+		if (parts.empty()) {
+			vector<uint32_t> all(movies);
+			for (int rank = 0; rank < movies; rank++)
+				all[rank] = rank;
+			return RoaringBitmap(all);
+		}
+		// Smallest first keeps the intermediate results small
+		sort(parts.begin(), parts.end(), [](const RoaringBitmap& a, const RoaringBitmap& b) {
+			return a.cardinality() < b.cardinality();
+		});
+		RoaringBitmap result = parts[0];
+		for (size_t k = 1; k < parts.size() && !result.empty(); k++)
+			result = RoaringBitmap::intersect(result, parts[k]);
+		return result;
+	}
+
+
+	size_t bytes() const {
+		size_t n = genreNames.bytes() + years.bytes() + popularities.bytes() + voteAverages.bytes() + voteCounts.bytes() + releaseDays.bytes();
+		for (auto* sets : { &genreSets, &yearSets, &ratingSets }) {
+			for (const RoaringBitmap& set : *sets)
+				n += set.bytes();
+		}
+		return n;
+	}
+
+
+	void save(SnapshotWriter& out) const {
+		out.write(&movies, 1);
+		genreNames.save(out);
+		for (const RoaringBitmap& set : genreSets)
+			set.save(out);
+		out.write(years);
+		for (const RoaringBitmap& set : yearSets)
+			set.save(out);
+		for (const RoaringBitmap& set : ratingSets)
+			set.save(out);
+		out.write(popularities);
+		out.write(voteAverages);
+		out.write(voteCounts);
+		out.write(releaseDays);
+	}
+
+
+	// The facets must cover exactly the given number of documents, and
+	// every set must hold ranks of them
+	void map(SnapshotReader& in, int documents) {
+		Column<int> size;
+		in.read(size);
+		if (size.size() != 1 || size[0] != documents) in.fail();
+		movies = in.good() ? documents : 0;
+		genreNames.map(in);
+		genreSets.assign(genreNames.size(), RoaringBitmap());
+		for (RoaringBitmap& set : genreSets)
+			set.map(in, movies);
+		in.read(years);
+		if (!years.ascending(true)) in.fail();
+		yearSets.assign(in.good() ? years.size() : 0, RoaringBitmap());
+		for (RoaringBitmap& set : yearSets)
+			set.map(in, movies);
+		ratingSets.assign(RATING_BANDS, RoaringBitmap());
+		for (RoaringBitmap& set : ratingSets)
+			set.map(in, movies);
+		in.read(popularities);
+		in.read(voteAverages);
+		in.read(voteCounts);
+		in.read(releaseDays);
+		size_t n = movies;
+		if (popularities.size() != n || voteAverages.size() != n || voteCounts.size() != n || releaseDays.size() != n)
+			in.fail();
+	}
+};
+
+
+// Movie Search Engine
+// Native searchMovies(): a case-insensitive substring search over the
+// titles, results by popularity (descending, ties in catalog order). The
+// trigram index narrows the catalog to candidates, each confirmed with
+// StringMatching::searchKMP; queries under three bytes scan every title.
+//
+// Movies are numbered by popularity rank and the trigram index is built
+// over the titles in that order, so candidates come out of the postings
+// already ranked: no sort is needed, and a search for the top k stops at
+// the k-th confirmed match however many titles would match in total.
+// Title prefixes (autocomplete) are answered by a TitleTrie, misspelled
+// words by a DeletionIndex, attribute filters by MovieFacets and ranked
+// multi-word queries over titles and casts by a Bm25Index, all over the
+// same ranks.
+class MovieSearch {
+protected:
+	const MovieCatalog& catalog;
+	TrigramIndex titles;
+	TitleTrie prefixes;
+	DeletionIndex typos;
+	MovieFacets facets;
+	Bm25Index ranked;
+	// Catalog index of the movie at each popularity rank
+	Column<int> byPopularity;
+
+
+	// pattern is the case-folded query, lps its KMP table; the mapped title
+	// is searched in place
+	bool titleMatches(int movie, const string& pattern, const vector<int>& lps) const {
+		return pattern.empty() || StringMatching::findFolded(catalog.title(movie), pattern, lps) >= 0;
+	}
+
+
+	// Matches among the allowed ranks (all when allowed is null), in rank
+	// order, at most limit
+	vector<int> find(const string& query, const RoaringBitmap* allowed, int limit) const {
+		vector<int> found;
+		if ((query.empty() && !allowed) || limit <= 0) return found;
+
+		// Folded and preprocessed once, not per candidate
+		string pattern;
+		for (char c : query)
+			pattern += FOLD_CASE[(unsigned char)c];
+		vector<int> lps = StringMatching::computeLPS(pattern);
+		auto confirm = [&](int rank) {
+			int movie = byPopularity[rank];
+			if (titleMatches(movie, pattern, lps))
+				found.push_back(movie);
+			return (int)found.size() < limit;
+		};
+		auto visit = [&](int rank) {
+			return (allowed && !allowed->contains(rank)) || confirm(rank);
+		};
+		if ((int)query.length() < TrigramIndex::GRAM && allowed) {
+			allowed->forEach([&](uint32_t rank) { return confirm(rank); });
+		}
+		else if (!titles.scanCandidates(query, visit)) {
+			for (int rank = 0; rank < catalog.size() && visit(rank); rank++) {}
+		}
+		return found;
+	}
+
+public:
+	// A title word counts this many times a cast word in ranked search
+	static constexpr int TITLE_WEIGHT = 2;
+
+
+	MovieSearch(const MovieCatalog& catalog) : catalog(catalog) {
+		vector<int> order(catalog.size());
+		for (int i = 0; i < catalog.size(); i++)
+			order[i] = i;
+		stable_sort(order.begin(), order.end(), [&](int a, int b) {
+			return catalog.popularity(a) > catalog.popularity(b);
+		});
+
+		vector<string_view> documents;
+		documents.reserve(catalog.size());
+		for (int movie : order)
+			documents.push_back(catalog.title(movie));
+		titles = TrigramIndex(documents);
+		prefixes = TitleTrie(documents);
+		typos = DeletionIndex(documents);
+
+		vector<vector<pair<string, int>>> words(order.size());
+		for (size_t rank = 0; rank < order.size(); rank++) {
+			for (string& word : DeletionIndex::split(documents[rank]))
+				words[rank].push_back({ move(word), TITLE_WEIGHT });
+			for (string_view actor : catalog.actors(order[rank])) {
+				for (string& word : DeletionIndex::split(actor))
+					words[rank].push_back({ move(word), 1 });
+			}
+		}
+		ranked = Bm25Index(words);
+		byPopularity = Column<int>(move(order));
+		facets = MovieFacets(catalog, byPopularity);
+	}
+
+
+	// Takes the prebuilt indexes from a snapshot the catalog was mapped
+	// from; check snapshot.good() afterwards
+	MovieSearch(const MovieCatalog& catalog, SnapshotReader& snapshot) : catalog(catalog) {
+		titles.map(snapshot, catalog.size());
+		prefixes.map(snapshot, catalog.size());
+		typos.map(snapshot, catalog.size());
+		facets.map(snapshot, catalog.size());
+		ranked.map(snapshot, catalog.size());
+		snapshot.read(byPopularity);
+		if ((int)byPopularity.size() != catalog.size() || !byPopularity.within(0, catalog.size() - 1))
+			snapshot.fail();
+	}
+
+
+	// Writes the catalog and the indexes as one snapshot
+	bool save(const string& path) const {
+		SnapshotWriter out;
+		if (!out.open(path)) return false;
+		catalog.save(out);
+		titles.save(out);
+		prefixes.save(out);
+		typos.save(out);
+		facets.save(out);
+		ranked.save(out);
+		out.write(byPopularity);
+		return out.close();
+	}
+
+
+	// Catalog indices of the (at most limit) most popular matching movies,
+	// most popular first
+	vector<int> search(const string& query, int limit = INT_MAX) const {
+		return find(query, nullptr, limit);
+	}
+
+
+	// The same, restricted to the movies passing the filter; an empty query
+	// lists all of them
+	vector<int> search(const string& query, const MovieFilter& filter, int limit = INT_MAX) const {
+		if (!filter.restricts()) return find(query, nullptr, limit);
+		RoaringBitmap allowed = facets.select(filter);
+		return find(query, &allowed, limit);
+	}
+
+
+	// Catalog indices of the (at most limit, and at most the trie's cache
+	// size) most popular movies whose title starts with the prefix
+	vector<int> suggest(const string& prefix, int limit = 10) const {
+		vector<int> found = prefixes.complete(prefix, limit);
+		for (int& rank : found)
+			rank = byPopularity[rank];
+		return found;
+	}
+
+
+	// Catalog indices of the movies whose title has, for every word of the
+	// query, a word within a small edit distance of it: 0 for words of up
+	// to 3 bytes, 1 up to 6 and maxDistance (at most 2) beyond. Best total
+	// distance first, then most popular; at most limit movies.
+	vector<int> searchFuzzy(const string& query, int limit = INT_MAX, int maxDistance = DeletionIndex::MAX_DISTANCE) const {
+		vector<int> found;
+		vector<string> queryWords = DeletionIndex::split(query);
+		if (queryWords.empty() || limit <= 0) return found;
+
+		// (rank, summed distance) of the titles matching every word so far
+		vector<pair<int, int>> matches, next;
+		for (size_t q = 0; q < queryWords.size(); q++) {
+			int allowed = min(maxDistance, ((int)queryWords[q].size() - 1) / 3);
+			next.clear();
+			for (auto [w, distance] : typos.lookup(queryWords[q], allowed)) {
+				auto list = typos.titles(w);
+				for (const int* p = list.first; p != list.second; p++)
+					next.push_back({ *p, distance });
+			}
+			// Closest word per title
+			sort(next.begin(), next.end());
+			next.erase(unique(next.begin(), next.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+				return a.first == b.first;
+			}), next.end());
+
+			if (q == 0) {
+				matches.swap(next);
+				continue;
+			}
+			size_t kept = 0;
+			for (size_t i = 0, j = 0; i < matches.size() && j < next.size();) {
+				if (matches[i].first < next[j].first) i++;
+				else if (matches[i].first > next[j].first) j++;
+				else {
+					matches[kept++] = { matches[i].first, matches[i].second + next[j].second };
+					i++;
+					j++;
+				}
+			}
+			matches.resize(kept);
+		}
+
+		sort(matches.begin(), matches.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+			return a.second != b.second ? a.second < b.second : a.first < b.first;
+		});
+		for (size_t i = 0; i < matches.size() && (int)found.size() < limit; i++)
+			found.push_back(byPopularity[matches[i].first]);
+		return found;
+	}
+
+
+	// Catalog indices of the (at most limit) movies whose title and cast
+	// best match the words of the query by BM25, best first; equal scores
+	// go to the more popular movie. Any one word is enough to match.
+	vector<int> searchRanked(const string& query, int limit = 10) const {
+		vector<int> found;
+		for (auto [rank, score] : ranked.top(DeletionIndex::split(query), limit))
+			found.push_back(byPopularity[rank]);
+		return found;
+	}
+
+
+	const TrigramIndex& titleIndex() const { return titles; }
+
+
+	const TitleTrie& prefixIndex() const { return prefixes; }
+
+
+	const DeletionIndex& typoIndex() const { return typos; }
+
+
+	const MovieFacets& facetIndex() const { return facets; }
+
+
+	const Bm25Index& rankedIndex() const { return ranked; }
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+
+// Range Filters
+// Range predicates over typed columns, producing one bit per row (bit
+// r % 64 of mask[r / 64]). narrowRange() clears the bits of the rows whose
+// value lies outside [low, high], so several predicates chain over one
+// mask. With SSE2 two doubles or four 32-bit integers are compared per
+// instruction and movemask packs the outcomes straight into mask bits:
+// no branch per row, and the loops run at memory speed.
+
+
+// Mask with the first n bits set
+inline vector<uint64_t> fullMask(size_t n) {
+	vector<uint64_t> mask((n + 63) / 64, ~uint64_t(0));
+	if (n % 64) mask.back() = (uint64_t(1) << (n % 64)) - 1;
+	return mask;
+}
+
+
+// NaN is outside every range
+inline void narrowRange(const double* values, size_t n, double low, double high, uint64_t* mask) {
+	size_t r = 0;
+#ifdef __SSE2__
+	const __m128d lo = _mm_set1_pd(low), hi = _mm_set1_pd(high);
+	for (; r + 64 <= n; r += 64) {
+		uint64_t bits = 0;
+		for (int k = 0; k < 64; k += 2) {
+			__m128d x = _mm_loadu_pd(values + r + k);
+			__m128d inside = _mm_and_pd(_mm_cmpge_pd(x, lo), _mm_cmple_pd(x, hi));
+			bits |= uint64_t(_mm_movemask_pd(inside)) << k;
+		}
+		mask[r / 64] &= bits;
+	}
+#endif
+	for (; r < n; r++) {
+		if (!(values[r] >= low && values[r] <= high))
+			mask[r / 64] &= ~(uint64_t(1) << (r % 64));
+	}
+}
+
+
+inline void narrowRange(const int* values, size_t n, int low, int high, uint64_t* mask) {
+	size_t r = 0;
+#ifdef __SSE2__
+	const __m128i lo = _mm_set1_epi32(low), hi = _mm_set1_epi32(high);
+	for (; r + 64 <= n; r += 64) {
+		uint64_t outside = 0;
+		for (int k = 0; k < 64; k += 4) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(values + r + k));
+			__m128i miss = _mm_or_si128(_mm_cmplt_epi32(x, lo), _mm_cmpgt_epi32(x, hi));
+			outside |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(miss))) << k;
+		}
+		mask[r / 64] &= ~outside;
+	}
+#endif
+	for (; r < n; r++) {
+		if (values[r] < low || values[r] > high)
+			mask[r / 64] &= ~(uint64_t(1) << (r % 64));
+	}
+}
+
+
+// Number of rows left in a mask
+inline size_t maskCount(const vector<uint64_t>& mask) {
+	size_t n = 0;
+	for (uint64_t word : mask)
+		n += __builtin_popcountll(word);
+	return n;
+}
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Snapshot.h"
+#include "List_Intersection.h"
+
+using namespace std;
+
+
+// Roaring Bitmap
+// Compressed set of 32-bit integers (Chambi, Lemire et al.). Values are
+// grouped by their high 16 bits into containers; a container with at most
+// 4096 values is a sorted array of the low 16 bits, a fuller one a plain
+// 65536-bit bitmap, so sparse and dense sets both stay small and every
+// operation works on whole containers. Bitmap containers are combined
+// 128 bits at a time with SSE2.
+//
+// The containers live in flat arrays (Column), which makes a bitmap a
+// handful of snapshot sections that map back without any decoding.
+class RoaringBitmap {
+protected:
+	static const int ARRAY_LIMIT = 4096;
+	static const int WORDS = 1024;
+
+	// Container i holds the values with high bits keys[i]: counts[i] low
+	// halves at arrays[starts[i]] when counts[i] <= ARRAY_LIMIT, otherwise
+	// WORDS bitmap words at words[starts[i]]
+	Column<uint16_t> keys;
+	Column<int> counts;
+	Column<int> starts;
+	Column<uint16_t> arrays;
+	Column<uint64_t> words;
+
+
+	struct Builder {
+		vector<uint16_t> keys;
+		vector<int> counts, starts;
+		vector<uint16_t> arrays;
+		vector<uint64_t> words;
+
+
+		void addArray(uint16_t key, const uint16_t* values, int n) {
+			if (n == 0) return;
+			keys.push_back(key);
+			counts.push_back(n);
+			starts.push_back(arrays.size());
+			arrays.insert(arrays.end(), values, values + n);
+		}
+
+
+		// A bitmap container, stored as an array when it has become sparse
+		void addWords(uint16_t key, const uint64_t* bits, int n) {
+			if (n <= ARRAY_LIMIT) {
+				vector<uint16_t> values;
+				values.reserve(n);
+				for (int w = 0; w < WORDS; w++) {
+					for (uint64_t b = bits[w]; b; b &= b - 1)
+						values.push_back(w * 64 + __builtin_ctzll(b));
+				}
+				addArray(key, values.data(), n);
+				return;
+			}
+			keys.push_back(key);
+			counts.push_back(n);
+			starts.push_back(words.size());
+			words.insert(words.end(), bits, bits + WORDS);
+		}
+
+
+		RoaringBitmap finish() {
+			RoaringBitmap bitmap;
+			bitmap.keys = Column<uint16_t>(move(keys));
+			bitmap.counts = Column<int>(move(counts));
+			bitmap.starts = Column<int>(move(starts));
+			bitmap.arrays = Column<uint16_t>(move(arrays));
+			bitmap.words = Column<uint64_t>(move(words));
+			return bitmap;
+		}
+	};
+
+
+	bool isArray(size_t i) const { return counts[i] <= ARRAY_LIMIT; }
+
+
+	const uint16_t* array(size_t i) const { return arrays.data() + starts[i]; }
+
+
+	const uint64_t* bitmap(size_t i) const { return words.data() + starts[i]; }
+
+
+	// Container i of either kind as bitmap words
+	void expand(size_t i, uint64_t* bits) const {
+		if (!isArray(i)) {
+			copy(bitmap(i), bitmap(i) + WORDS, bits);
+			return;
+		}
+		fill(bits, bits + WORDS, 0);
+		for (int k = 0; k < counts[i]; k++)
+			bits[array(i)[k] >> 6] |= uint64_t(1) << (array(i)[k] & 63);
+	}
+
+
+	// out = a & b (or a | b) over WORDS words; returns the population
+	static int combine(const uint64_t* a, const uint64_t* b, uint64_t* out, bool intersect) {
+		int n = 0;
+#ifdef __SSE2__
+		for (int w = 0; w < WORDS; w += 2) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(a + w));
+			__m128i y = _mm_loadu_si128((const __m128i*)(b + w));
+			_mm_storeu_si128((__m128i*)(out + w), intersect ? _mm_and_si128(x, y) : _mm_or_si128(x, y));
+			n += __builtin_popcountll(out[w]) + __builtin_popcountll(out[w + 1]);
+		}
+#else
+		for (int w = 0; w < WORDS; w++) {
+			out[w] = intersect ? a[w] & b[w] : a[w] | b[w];
+			n += __builtin_popcountll(out[w]);
+		}
+#endif
+		return n;
+	}
+
+public:
+	RoaringBitmap() {}
+
+
+	// From values in ascending order
+	RoaringBitmap(const vector<uint32_t>& values) {
+		Builder builder;
+		vector<uint16_t> low;
+		for (size_t i = 0; i < values.size();) {
+			uint16_t key = values[i] >> 16;
+			low.clear();
+			for (; i < values.size() && (values[i] >> 16) == key; i++) {
+				if (low.empty() || low.back() != uint16_t(values[i]))
+					low.push_back(uint16_t(values[i]));
+			}
+			if (low.size() <= ARRAY_LIMIT) {
+				builder.addArray(key, low.data(), low.size());
+				continue;
+			}
+			vector<uint64_t> bits(WORDS, 0);
+			for (uint16_t v : low)
+				bits[v >> 6] |= uint64_t(1) << (v & 63);
+			builder.addWords(key, bits.data(), low.size());
+		}
+		*this = builder.finish();
+	}
+
+
+	// The set bits of a row mask (bit r % 64 of mask[r / 64] is value r)
+	static RoaringBitmap fromMask(const vector<uint64_t>& mask) {
+		Builder builder;
+		vector<uint64_t> bits(WORDS);
+		for (size_t first = 0; first < mask.size(); first += WORDS) {
+			size_t last = min(mask.size(), first + WORDS);
+			fill(copy(mask.begin() + first, mask.begin() + last, bits.begin()), bits.end(), 0);
+			int n = 0;
+			for (uint64_t w : bits)
+				n += __builtin_popcountll(w);
+			if (n > 0) builder.addWords(first / WORDS, bits.data(), n);
+		}
+		return builder.finish();
+	}
+
+
+	bool contains(uint32_t value) const {
+		auto at = lower_bound(keys.begin(), keys.end(), uint16_t(value >> 16));
+		if (at == keys.end() || *at != uint16_t(value >> 16)) return false;
+		size_t i = at - keys.begin();
+		uint16_t low = value;
+		if (isArray(i))
+			return binary_search(array(i), array(i) + counts[i], low);
+		return (bitmap(i)[low >> 6] >> (low & 63)) & 1;
+	}
+
+
+	long long cardinality() const {
+		long long n = 0;
+		for (size_t i = 0; i < counts.size(); i++)
+			n += counts[i];
+		return n;
+	}
+
+
+	bool empty() const { return keys.empty(); }
+
+
+	// Calls visit(value) in ascending order until it returns false
+	template <class Visit>
+	void forEach(Visit visit) const {
+		for (size_t i = 0; i < keys.size(); i++) {
+			uint32_t high = uint32_t(keys[i]) << 16;
+			if (isArray(i)) {
+				for (int k = 0; k < counts[i]; k++) {
+					if (!visit(high | array(i)[k])) return;
+				}
+				continue;
+			}
+			for (int w = 0; w < WORDS; w++) {
+				for (uint64_t b = bitmap(i)[w]; b; b &= b - 1) {
+					if (!visit(high | (w * 64 + __builtin_ctzll(b)))) return;
+				}
+			}
+		}
+	}
+
+
+	static RoaringBitmap intersect(const RoaringBitmap& a, const RoaringBitmap& b) {
+		Builder builder;
+		vector<uint16_t> values;
+		vector<uint64_t> bits(WORDS);
+		for (size_t i = 0, j = 0; i < a.keys.size() && j < b.keys.size();) {
+			if (a.keys[i] < b.keys[j]) { i++; continue; }
+			if (a.keys[i] > b.keys[j]) { j++; continue; }
+			uint16_t key = a.keys[i];
+			if (!a.isArray(i) && !b.isArray(j)) {
+				int n = combine(a.bitmap(i), b.bitmap(j), bits.data(), true);
+				builder.addWords(key, bits.data(), n);
+			}
+			else if (a.isArray(i) && b.isArray(j)) {
+				values.resize(min(a.counts[i], b.counts[j]));
+				int n = ::intersect(a.array(i), a.counts[i], b.array(j), b.counts[j], values.data());
+				builder.addArray(key, values.data(), n);
+			}
+			else {
+				// Array against bitmap: keep the array values whose bit is set
+				size_t ai = a.isArray(i) ? i : j;
+				const RoaringBitmap& sparse = a.isArray(i) ? a : b;
+				const uint64_t* dense = a.isArray(i) ? b.bitmap(j) : a.bitmap(i);
+				values.clear();
+				for (int k = 0; k < sparse.counts[ai]; k++) {
+					uint16_t v = sparse.array(ai)[k];
+					if ((dense[v >> 6] >> (v & 63)) & 1)
+						values.push_back(v);
+				}
+				builder.addArray(key, values.data(), values.size());
+			}
+			i++;
+			j++;
+		}
+		return builder.finish();
+	}
+
+
+	static RoaringBitmap unite(const RoaringBitmap& a, const RoaringBitmap& b) {
+		Builder builder;
+		vector<uint16_t> values;
+		vector<uint64_t> bits(WORDS), other(WORDS);
+		size_t i = 0, j = 0;
+		while (i < a.keys.size() || j < b.keys.size()) {
+			bool fromA = j == b.keys.size() || (i < a.keys.size() && a.keys[i] < b.keys[j]);
+			bool fromB = i == a.keys.size() || (j < b.keys.size() && b.keys[j] < a.keys[i]);
+			if (fromA || fromB) {
+				const RoaringBitmap& only = fromA ? a : b;
+				size_t k = fromA ? i++ : j++;
+				if (only.isArray(k)) builder.addArray(only.keys[k], only.array(k), only.counts[k]);
+				else builder.addWords(only.keys[k], only.bitmap(k), only.counts[k]);
+				continue;
+			}
+
+			uint16_t key = a.keys[i];
+			if (a.isArray(i) && b.isArray(j) && a.counts[i] + b.counts[j] <= ARRAY_LIMIT) {
+				values.resize(a.counts[i] + b.counts[j]);
+				int n = set_union(a.array(i), a.array(i) + a.counts[i], b.array(j), b.array(j) + b.counts[j], values.begin()) - values.begin();
+				builder.addArray(key, values.data(), n);
+			}
+			else {
+				a.expand(i, bits.data());
+				b.expand(j, other.data());
+				int n = combine(bits.data(), other.data(), bits.data(), false);
+				builder.addWords(key, bits.data(), n);
+			}
+			i++;
+			j++;
+		}
+		return builder.finish();
+	}
+
+
+	// Union of many bitmaps at once: each key's containers are ORed into one
+	// bitmap buffer, with no intermediate results
+	static RoaringBitmap unite(const vector<const RoaringBitmap*>& sets) {
+		vector<uint16_t> allKeys;
+		for (const RoaringBitmap* set : sets)
+			allKeys.insert(allKeys.end(), set->keys.begin(), set->keys.end());
+		sort(allKeys.begin(), allKeys.end());
+		allKeys.erase(unique(allKeys.begin(), allKeys.end()), allKeys.end());
+
+		Builder builder;
+		vector<uint64_t> bits(WORDS);
+		vector<size_t> next(sets.size(), 0);
+		for (uint16_t key : allKeys) {
+			fill(bits.begin(), bits.end(), 0);
+			for (size_t s = 0; s < sets.size(); s++) {
+				const RoaringBitmap& set = *sets[s];
+				size_t& i = next[s];
+				if (i == set.keys.size() || set.keys[i] != key) continue;
+				if (set.isArray(i)) {
+					for (int k = 0; k < set.counts[i]; k++)
+						bits[set.array(i)[k] >> 6] |= uint64_t(1) << (set.array(i)[k] & 63);
+				}
+				else combine(bits.data(), set.bitmap(i), bits.data(), false);
+				i++;
+			}
+			int n = 0;
+			for (uint64_t w : bits)
+				n += __builtin_popcountll(w);
+			builder.addWords(key, bits.data(), n);
+		}
+		return builder.finish();
+	}
+
+
+	size_t bytes() const {
+		return keys.bytes() + counts.bytes() + starts.bytes() + arrays.bytes() + words.bytes();
+	}
+
+
+	void save(SnapshotWriter& out) const {
+		out.write(keys);
+		out.write(counts);
+		out.write(starts);
+		out.write(arrays);
+		out.write(words);
+	}
+
+
+	// Containers must be sorted by key and hold what their counts say: the
+	// merge and intersection kernels rely on strictly increasing arrays.
+	// Every value must be below limit.
+	void map(SnapshotReader& in, uint64_t limit = uint64_t(1) << 32) {
+		in.read(keys);
+		in.read(counts);
+		in.read(starts);
+		in.read(arrays);
+		in.read(words);
+		bool valid = counts.size() == keys.size() && starts.size() == keys.size() && keys.ascending(true);
+		uint64_t last = 0;
+		for (size_t i = 0; valid && i < keys.size(); i++) {
+			valid = counts[i] > 0 && counts[i] <= 65536 && starts[i] >= 0 && (isArray(i)
+				? size_t(starts[i]) + counts[i] <= arrays.size()
+				: size_t(starts[i]) + WORDS <= words.size());
+			if (!valid) break;
+			uint32_t high = uint32_t(keys[i]) << 16;
+			if (isArray(i)) {
+				for (int k = 1; valid && k < counts[i]; k++)
+					valid = array(i)[k - 1] < array(i)[k];
+				last = high | array(i)[counts[i] - 1];
+				continue;
+			}
+			int n = 0, top = 0;
+			for (int w = 0; w < WORDS; w++) {
+				n += __builtin_popcountll(bitmap(i)[w]);
+				if (bitmap(i)[w]) top = w * 64 + 63 - __builtin_clzll(bitmap(i)[w]);
+			}
+			valid = n == counts[i];
+			last = high | top;
+		}
+		if (!valid || (!keys.empty() && last >= limit)) in.fail();
+	}
+};
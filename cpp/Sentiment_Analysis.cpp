@@ -0,0 +1,83 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+#include "Sentiment_Engine.h"
+#include "Sentiment_Pipeline.h"
+
+using namespace std;
+
+
+// Usage: sentiment [--lexicon data.json] [file]
+//        sentiment --batch [--field text] [--threads n] [--lexicon data.json] [file]
+// Analyzes the file (or standard input) and prints the result as JSON. With
+// --batch the input is JSON lines, one review object per line, and every
+// line gets one result line in the same order.
+int main(int argc, char** argv) {
+	SentimentEngine engine;
+	string input;
+	string field = "text";
+	bool batch = false;
+	int threads = 0;
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--lexicon" && i + 1 < argc) {
+			if (!engine.load(argv[++i])) {
+				cerr << "cannot load lexicon " << argv[i] << endl;
+				return 1;
+			}
+		}
+		else if (arg == "--batch") {
+			batch = true;
+		}
+		else if (arg == "--field" && i + 1 < argc) {
+			field = argv[++i];
+		}
+		else if (arg == "--threads" && i + 1 < argc) {
+			threads = atoi(argv[++i]);
+		}
+		else {
+			input = arg;
+		}
+	}
+
+	if (batch) {
+		// The reader thread must not flush cout (tied to cin) under the writer
+		ios::sync_with_stdio(false);
+		cin.tie(nullptr);
+		SentimentPipeline pipeline(engine, field, threads);
+		if (input.empty()) {
+			pipeline.run(cin, cout);
+			return 0;
+		}
+
+		ifstream in(input, ios::binary);
+		if (!in) {
+			cerr << "cannot open " << input << endl;
+			return 1;
+		}
+		pipeline.run(in, cout);
+		return 0;
+	}
+
+	stringstream buffer;
+	if (input.empty()) {
+		buffer << cin.rdbuf();
+	}
+	else {
+		ifstream in(input, ios::binary);
+		if (!in) {
+			cerr << "cannot open " << input << endl;
+			return 1;
+		}
+		buffer << in.rdbuf();
+	}
+
+	SentimentResult result = engine.analyze(buffer.str());
+	cout << engine.toJson(result) << endl;
+
+	return 0;
+}
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include "String_Matching.h"
+#include "Aho_Corasick.h"
+#include "Json_Reader.h"
+#include "Sentiment_Lexicon.h"
+
+using namespace std;
+
+
+// One detected keyword, as in categoryResults[category].matches in
+// js/sentiment.js
+struct KeywordMatch {
+	int keyword;
+	int count;
+	int weight;
+	int score;
+	vector<int> positions;
+};
+
+
+struct CategoryResult {
+	vector<KeywordMatch> matches;
+	int totalWeight = 0;
+	int count = 0;
+};
+
+
+// Mirror of the object returned by analyzeSentiment()
+struct SentimentResult {
+	vector<CategoryResult> categoryResults;
+	// Categories with at least one match, by totalWeight (descending)
+	vector<int> sortedCategories;
+	// (category, index into its matches), by score (descending)
+	vector<pair<int, int>> detectedWords;
+	string dominantEmotion = "neutral";
+	int totalScore = 0;
+	int totalMatches = 0;
+	double processingTime = 0;
+	int wordCount = 0;
+	double sentimentDensity = 0;
+	string severityLevel = "LOW";
+	string severityColor = "#4CAF50";
+	int concernScore = 0;
+	int positiveScore = 0;
+	int negativeScore = 0;
+	int neutralScore = 0;
+};
+
+
+// Sentiment Analysis Engine
+// Native counterpart of analyzeSentiment() in js/sentiment.js. Instead of one
+// search per keyword, all keywords of all categories are found by a single
+// whole-word Aho-Corasick pass (StringMatching::searchKeywords) that also
+// counts the words of the text. The default lexicon is the compiled one from
+// Sentiment_Lexicon.h; load() replaces it with a data.json read at run time.
+class SentimentEngine {
+protected:
+	vector<string> categoryNames;
+	vector<LexiconEntry> entries;
+	// Backing storage for entries loaded from disk
+	vector<string> strings;
+	AhoCorasick automaton;
+	bool compiled = true;
+
+
+	static bool isSpace(unsigned char c) {
+		return c == ' ' || (c >= '\t' && c <= '\r');
+	}
+
+
+	template <typename Automaton>
+	void scan(const Automaton& keywords, const string& text, vector<vector<int>>& positions, int& wordCount) const {
+		bool inWord = false;
+		wordCount = 0;
+
+		// findMatches() in js/sentiment.js only keeps whole-word matches
+		StringMatching::searchKeywords(text, true, keywords,
+			[&](int keyword, int start) {
+				positions[keyword].push_back(start);
+			},
+			[&](unsigned char c) {
+				bool space = isSpace(c);
+				wordCount += !space && !inWord;
+				inWord = !space;
+			});
+	}
+
+public:
+	SentimentEngine() {
+		categoryNames.assign(SentimentLexicon::categories, SentimentLexicon::categories + SentimentLexicon::CATEGORIES);
+		entries.assign(SentimentLexicon::entries, SentimentLexicon::entries + SentimentLexicon::KEYWORDS);
+	}
+
+
+	// A copy's entries would still point into the original's strings. A
+	// move hands over the string buffer itself, so the pointers stay valid.
+	SentimentEngine(const SentimentEngine&) = delete;
+	SentimentEngine& operator=(const SentimentEngine&) = delete;
+	SentimentEngine(SentimentEngine&&) = default;
+	SentimentEngine& operator=(SentimentEngine&&) = default;
+
+
+	// Loads a lexicon in the js/data.json format; false (and the current
+	// lexicon kept) when the file cannot be read or parsed
+	bool load(const string& path) {
+		ifstream in(path, ios::binary);
+		if (!in) return false;
+		stringstream buffer;
+		buffer << in.rdbuf();
+		string json = buffer.str();
+
+		JsonValue root;
+		if (!JsonReader(json.data(), json.size()).parse(root) || root.type != JsonValue::OBJECT)
+			return false;
+
+		vector<string> names;
+		vector<string> words, suggestions;
+		vector<int> weights, categories;
+		for (const auto& category : root.object) {
+			names.push_back(category.first);
+			for (const auto& item : category.second.array) {
+				const JsonValue* word = item.get("word");
+				const JsonValue* weight = item.get("weight");
+				const JsonValue* suggestion = item.get("suggestion");
+				if (word == nullptr || word->str.empty()) continue;
+
+				string lower = word->str;
+				for (char& c : lower) {
+					if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+				}
+				words.push_back(lower);
+				weights.push_back((weight != nullptr && weight->number != 0) ? int(weight->number) : 5);
+				categories.push_back(names.size() - 1);
+				suggestions.push_back(suggestion != nullptr ? suggestion->str : "");
+			}
+		}
+
+		categoryNames = names;
+		automaton = AhoCorasick(words);
+		strings.clear();
+		strings.reserve(words.size() * 2);
+		entries.clear();
+		for (size_t i = 0; i < words.size(); i++) {
+			strings.push_back(words[i]);
+			const char* word = strings.back().c_str();
+			strings.push_back(suggestions[i]);
+			entries.push_back({ word, weights[i], categories[i], strings.back().c_str() });
+		}
+		compiled = false;
+		return true;
+	}
+
+
+	const vector<string>& categories() const { return categoryNames; }
+
+
+	const LexiconEntry& keyword(int id) const { return entries[id]; }
+
+
+	SentimentResult analyze(const string& text) const {
+		auto startTime = chrono::steady_clock::now();
+		SentimentResult result;
+
+		vector<vector<int>> positions(entries.size());
+		if (compiled)
+			scan(SentimentLexicon::automaton, text, positions, result.wordCount);
+		else
+			scan(automaton, text, positions, result.wordCount);
+
+		// Per-keyword totals, visited in lexicon order like the JS loops
+		result.categoryResults.resize(categoryNames.size());
+		for (size_t k = 0; k < entries.size(); k++) {
+			int count = positions[k].size();
+			if (count == 0) continue;
+
+			const LexiconEntry& entry = entries[k];
+			CategoryResult& category = result.categoryResults[entry.category];
+			int score = count * entry.weight;
+			category.matches.push_back({ int(k), count, entry.weight, score, move(positions[k]) });
+			category.totalWeight += score;
+			category.count += count;
+			result.totalScore += score;
+			result.totalMatches += count;
+			result.detectedWords.push_back({ entry.category, int(category.matches.size()) - 1 });
+		}
+
+		for (size_t c = 0; c < categoryNames.size(); c++) {
+			if (result.categoryResults[c].count > 0)
+				result.sortedCategories.push_back(c);
+		}
+		stable_sort(result.sortedCategories.begin(), result.sortedCategories.end(), [&](int a, int b) {
+			return result.categoryResults[a].totalWeight > result.categoryResults[b].totalWeight;
+		});
+		stable_sort(result.detectedWords.begin(), result.detectedWords.end(), [&](const pair<int, int>& a, const pair<int, int>& b) {
+			return result.categoryResults[a.first].matches[a.second].score > result.categoryResults[b.first].matches[b.second].score;
+		});
+		if (!result.sortedCategories.empty())
+			result.dominantEmotion = categoryNames[result.sortedCategories[0]];
+
+		// Scoring, exactly as in analyzeSentiment()
+		int wordCount = result.wordCount;
+		result.sentimentDensity = wordCount > 0 ? (double(result.totalMatches) / wordCount) * 100 : 0;
+
+		double maxPossibleScore = wordCount * 10.0;
+		double concernScore = 0;
+		if (maxPossibleScore > 0)
+			concernScore = min(100.0, (result.totalScore / maxPossibleScore) * 100 * 3);
+
+		if (result.totalMatches == 0) {
+			result.positiveScore = 85;
+			result.negativeScore = 0;
+			result.neutralScore = 15;
+		}
+		else {
+			result.negativeScore = (int)round(min(100.0, concernScore));
+			double densityFactor = min(1.0, result.sentimentDensity / 20);
+			result.positiveScore = (int)round(max(0.0, (100 - result.negativeScore) * (1 - densityFactor)));
+			result.neutralScore = 100 - result.positiveScore - result.negativeScore;
+		}
+
+		if (result.negativeScore > 60 || result.sentimentDensity > 15) {
+			result.severityLevel = "HIGH";
+			result.severityColor = "#F44336";
+		}
+		else if (result.negativeScore > 30 || result.sentimentDensity > 8) {
+			result.severityLevel = "MODERATE";
+			result.severityColor = "#FF9800";
+		}
+		result.concernScore = (int)round(concernScore);
+
+		result.processingTime = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+		return result;
+	}
+
+
+	// Serializes a result with the field names the web page uses
+	string toJson(const SentimentResult& result) const {
+		char number[32];
+		string out = "{\"dominantEmotion\":" + jsonString(result.dominantEmotion);
+		out += ",\"totalScore\":" + to_string(result.totalScore);
+		out += ",\"totalMatches\":" + to_string(result.totalMatches);
+		out += ",\"wordCount\":" + to_string(result.wordCount);
+		snprintf(number, sizeof(number), "%.2f", result.sentimentDensity);
+		out += ",\"sentimentDensity\":\"" + string(number) + "\"";
+		out += ",\"severityLevel\":" + jsonString(result.severityLevel);
+		out += ",\"severityColor\":" + jsonString(result.severityColor);
+		out += ",\"concernScore\":" + to_string(result.concernScore);
+		out += ",\"positiveScore\":" + to_string(result.positiveScore);
+		out += ",\"negativeScore\":" + to_string(result.negativeScore);
+		out += ",\"neutralScore\":" + to_string(result.neutralScore);
+
+		out += ",\"categoryResults\":{";
+		for (size_t c = 0; c < categoryNames.size(); c++) {
+			const CategoryResult& category = result.categoryResults[c];
+			if (c > 0) out += ",";
+			out += jsonString(categoryNames[c]) + ":{\"totalWeight\":" + to_string(category.totalWeight);
+			out += ",\"count\":" + to_string(category.count) + ",\"matches\":[";
+			for (size_t m = 0; m < category.matches.size(); m++) {
+				const KeywordMatch& match = category.matches[m];
+				const LexiconEntry& entry = entries[match.keyword];
+				if (m > 0) out += ",";
+				out += "{\"word\":" + jsonString(entry.word);
+				out += ",\"count\":" + to_string(match.count);
+				out += ",\"weight\":" + to_string(match.weight);
+				out += ",\"score\":" + to_string(match.score);
+				out += ",\"suggestion\":" + jsonString(entry.suggestion);
+				out += ",\"positions\":[";
+				for (size_t p = 0; p < match.positions.size(); p++) {
+					if (p > 0) out += ",";
+					out += to_string(match.positions[p]);
+				}
+				out += "]}";
+			}
+			out += "]}";
+		}
+		out += "}";
+
+		snprintf(number, sizeof(number), "%.2f", result.processingTime);
+		out += ",\"processingTime\":\"" + string(number) + "\"}";
+		return out;
+	}
+};
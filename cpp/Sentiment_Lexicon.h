@@ -0,0 +1,188 @@
+// Generated by cpp/Lexicon_Codegen.cpp from js/data.json - do not edit.
+#pragma once
+
+#include "Aho_Corasick.h"
+
+
+namespace SentimentLexicon {
+
+constexpr int CATEGORIES = 15;
+constexpr int KEYWORDS = 150;
+constexpr int STATES = 835;
+constexpr int CLASSES = 29;
+
+inline constexpr const char* categories[CATEGORIES] = {
+	"anger",
+	"sadness",
+	"stress",
+	"anxiety",
+	"loneliness",
+	"cyberbullying",
+	"trauma",
+	"self_harm",
+	"eating_disorders",
+	"fear",
+	"grief",
+	"low_self_esteem",
+	"addiction",
+	"betrayal",
+	"workplace_toxicity",
+};
+
+inline constexpr LexiconEntry entries[KEYWORDS] = {
+	{ "hate", 8, 0, "dislike" },
+	{ "furious", 9, 0, "upset" },
+	{ "stupid", 7, 0, "unwise" },
+	{ "revenge", 10, 0, "justice" },
+	{ "idiot", 8, 0, "misinformed" },
+	{ "disgusting", 8, 0, "unpleasant" },
+	{ "resent", 7, 0, "envy" },
+	{ "rage", 10, 0, "strong anger" },
+	{ "scum", 9, 0, "unpleasant person" },
+	{ "hostile", 8, 0, "unfriendly" },
+	{ "failure", 9, 1, "learning step" },
+	{ "hopeless", 10, 1, "seeking hope" },
+	{ "depressed", 9, 1, "feeling low" },
+	{ "miserable", 8, 1, "uncomfortable" },
+	{ "worthless", 10, 1, "valuable" },
+	{ "heartbroken", 9, 1, "healing" },
+	{ "sorrow", 7, 1, "reflection" },
+	{ "gloomy", 6, 1, "shadowy" },
+	{ "unhappy", 7, 1, "dissatisfied" },
+	{ "pathetic", 8, 1, "struggling" },
+	{ "overwhelmed", 9, 2, "busy" },
+	{ "burnout", 9, 2, "need rest" },
+	{ "exhausted", 8, 2, "tired" },
+	{ "pressure", 7, 2, "challenge" },
+	{ "deadline", 6, 2, "milestone" },
+	{ "suffocating", 10, 2, "crowded" },
+	{ "unbearable", 9, 2, "hard" },
+	{ "overworked", 8, 2, "fully loaded" },
+	{ "collapsing", 10, 2, "needing a break" },
+	{ "tension", 7, 2, "focus" },
+	{ "anxious", 8, 3, "concerned" },
+	{ "panic", 9, 3, "sudden rush" },
+	{ "worried", 7, 3, "thinking" },
+	{ "nervous", 6, 3, "alert" },
+	{ "dread", 9, 3, "anticipation" },
+	{ "restless", 7, 3, "active" },
+	{ "shaking", 8, 3, "vibrating" },
+	{ "apprehensive", 7, 3, "aware" },
+	{ "jittery", 6, 3, "energetic" },
+	{ "overthinking", 7, 3, "analyzing" },
+	{ "alone", 7, 4, "independent" },
+	{ "isolated", 8, 4, "private" },
+	{ "abandoned", 10, 4, "let go" },
+	{ "rejected", 9, 4, "not chosen" },
+	{ "ignored", 8, 4, "overlooked" },
+	{ "unloved", 10, 4, "seeking care" },
+	{ "excluded", 8, 4, "left out" },
+	{ "invisible", 7, 4, "quiet" },
+	{ "solitary", 6, 4, "self-reliant" },
+	{ "lonesome", 7, 4, "quiet" },
+	{ "fat", 9, 5, "unique shape" },
+	{ "ugly", 9, 5, "unconventional" },
+	{ "kill yourself", 10, 5, "please stay safe" },
+	{ "freak", 8, 5, "unique" },
+	{ "loser", 8, 5, "rising star" },
+	{ "nerd", 5, 5, "genius" },
+	{ "dumb", 7, 5, "learning" },
+	{ "weak", 7, 5, "growing" },
+	{ "garbage", 8, 5, "undervalued" },
+	{ "weirdo", 7, 5, "original" },
+	{ "ptsd", 9, 6, "condition" },
+	{ "abuse", 10, 6, "mistreatment" },
+	{ "victim", 9, 6, "survivor" },
+	{ "flashback", 9, 6, "memory" },
+	{ "assault", 10, 6, "attack" },
+	{ "trigger", 8, 6, "spark" },
+	{ "traumatized", 9, 6, "impacted" },
+	{ "scarred", 8, 6, "healing" },
+	{ "nightmare", 8, 6, "bad dream" },
+	{ "shattered", 9, 6, "rebuilding" },
+	{ "cutting", 10, 7, "hurting" },
+	{ "suicide", 10, 7, "mental crisis" },
+	{ "end it all", 10, 7, "find help" },
+	{ "die", 10, 7, "survive" },
+	{ "bleeding", 9, 7, "injury" },
+	{ "poison", 9, 7, "harmful" },
+	{ "hanging", 10, 7, "distress" },
+	{ "worthless life", 10, 7, "precious life" },
+	{ "jump", 8, 7, "leap" },
+	{ " overdose", 10, 7, "medical emergency" },
+	{ "anorexia", 9, 8, "health issue" },
+	{ "bulimia", 9, 8, "struggle" },
+	{ "skinny", 7, 8, "lean" },
+	{ "starve", 10, 8, "fast" },
+	{ "purge", 10, 8, "cleanse" },
+	{ "obese", 8, 8, "large" },
+	{ "calorie", 5, 8, "energy unit" },
+	{ "binge", 9, 8, "overeat" },
+	{ "vomit", 9, 8, "get sick" },
+	{ "fatness", 8, 8, "body mass" },
+	{ "terrified", 9, 9, "very afraid" },
+	{ "danger", 8, 9, "risk" },
+	{ "threat", 9, 9, "warning" },
+	{ "scared", 7, 9, "cautious" },
+	{ "horror", 8, 9, "intense fear" },
+	{ "creepy", 6, 9, "unusual" },
+	{ "spooky", 5, 9, "mysterious" },
+	{ "frightened", 7, 9, "startled" },
+	{ "alarmed", 7, 9, "alert" },
+	{ "paralyzed", 9, 9, "frozen" },
+	{ "death", 9, 10, "passing" },
+	{ "loss", 8, 10, "absence" },
+	{ "funeral", 7, 10, "memorial" },
+	{ "buried", 8, 10, "gone" },
+	{ "missing", 6, 10, "away" },
+	{ "mourning", 8, 10, "honoring" },
+	{ "orphan", 9, 10, "parentless" },
+	{ "widow", 8, 10, "partnerless" },
+	{ "tragedy", 9, 10, "sad event" },
+	{ "farewell", 5, 10, "goodbye" },
+	{ "not good enough", 9, 11, "growing" },
+	{ "ugly", 8, 11, "unique" },
+	{ "ashamed", 8, 11, "regretful" },
+	{ "embarrassed", 7, 11, "shy" },
+	{ "failure", 9, 11, "triumph in progress" },
+	{ "clumsy", 5, 11, "learning" },
+	{ "loser", 8, 11, "evolving" },
+	{ "mistake", 6, 11, "lesson" },
+	{ "guilty", 7, 11, "responsible" },
+	{ "awkward", 5, 11, "original" },
+	{ "cravings", 8, 12, "desire" },
+	{ "relapse", 9, 12, "setback" },
+	{ "withdrawal", 9, 12, "recovery process" },
+	{ "alcoholic", 8, 12, "struggling" },
+	{ "drugs", 9, 12, "substances" },
+	{ "junkie", 10, 12, "patient" },
+	{ "sober", 4, 12, "clean" },
+	{ "addict", 9, 12, "person in recovery" },
+	{ "pills", 7, 12, "medication" },
+	{ "smoke", 6, 12, "vape" },
+	{ "cheated", 9, 13, "betrayed" },
+	{ "lied", 8, 13, "misled" },
+	{ "backstabbed", 10, 13, "let down" },
+	{ "unfaithful", 9, 13, "disloyal" },
+	{ "traitor", 10, 13, "opponent" },
+	{ "scam", 8, 13, "fraud" },
+	{ "deceived", 9, 13, "tricked" },
+	{ "faked", 7, 13, "simulated" },
+	{ "double-crossed", 10, 13, "misled" },
+	{ "distrust", 7, 13, "caution" },
+	{ "fired", 9, 14, "let go" },
+	{ "bossy", 7, 14, "directive" },
+	{ "harassment", 10, 14, "misconduct" },
+	{ "hostile", 8, 14, "challenging" },
+	{ "micromanage", 7, 14, "closely monitor" },
+	{ "unpaid", 8, 14, "volunteer" },
+	{ "unfair", 7, 14, "biased" },
+	{ "demoted", 9, 14, "repositioned" },
+	{ "overtime", 6, 14, "extra hours" },
+	{ "quitting", 7, 14, "resigning" },
+};
+
+inline constexpr StaticAhoCorasick<STATES, CLASSES, KEYWORDS> automaton(entries);
+static_assert(automaton.stateCount() == STATES, "regenerate Sentiment_Lexicon.h");
+
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "Sentiment_Engine.h"
+#include "Json_Reader.h"
+
+using namespace std;
+
+
+// Blocking FIFO with a fixed capacity: push() waits while the queue is full,
+// pop() waits while it is empty and returns false once it is closed and
+// drained.
+template <typename T>
+class BoundedQueue {
+protected:
+	deque<T> items;
+	size_t capacity;
+	bool closed = false;
+	mutex lock;
+	condition_variable notFull;
+	condition_variable notEmpty;
+
+public:
+	BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+
+	void push(T item) {
+		unique_lock<mutex> guard(lock);
+		notFull.wait(guard, [&] { return items.size() < capacity; });
+		items.push_back(move(item));
+		notEmpty.notify_one();
+	}
+
+
+	bool pop(T& item) {
+		unique_lock<mutex> guard(lock);
+		notEmpty.wait(guard, [&] { return !items.empty() || closed; });
+		if (items.empty()) return false;
+		item = move(items.front());
+		items.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+
+
+	void close() {
+		lock_guard<mutex> guard(lock);
+		closed = true;
+		notEmpty.notify_all();
+	}
+};
+
+
+// Batch Sentiment Pipeline
+// Scores a JSON-lines corpus (one review object per line) in three stages:
+// a reader that cuts the input into numbered batches, a pool of workers that
+// parse and score them with a shared SentimentEngine, and a writer that
+// restores input order. The reader may run at most a fixed window of
+// batches ahead of the writer, so the queues and the writer's reorder buffer
+// stay proportional to threads * batchSize however large the corpus is.
+class SentimentPipeline {
+protected:
+	struct Batch {
+		long long sequence = 0;
+		vector<long long> numbers;
+		vector<string> lines;
+	};
+
+	const SentimentEngine& engine;
+	string field;
+	int threads;
+	int batchSize;
+
+
+	// One output line: {"line":n,"id":...,<result fields>} or an error
+	string scoreLine(const string& line, long long number) const {
+		string prefix = "{\"line\":" + to_string(number);
+
+		JsonValue review;
+		if (!JsonReader(line.data(), line.size()).parse(review) || review.type != JsonValue::OBJECT)
+			return prefix + ",\"error\":\"invalid JSON\"}";
+
+		const JsonValue* id = review.get("id");
+		if (id != nullptr) {
+			if (id->type == JsonValue::STRING)
+				prefix += ",\"id\":" + jsonString(id->str);
+			else if (id->type == JsonValue::NUMBER)
+				prefix += ",\"id\":" + to_string((long long)id->number);
+		}
+
+		const JsonValue* text = review.get(field);
+		if (text == nullptr || text->type != JsonValue::STRING)
+			return prefix + ",\"error\":" + jsonString("missing \"" + field + "\" field") + "}";
+
+		string result = engine.toJson(engine.analyze(text->str));
+		return prefix + "," + result.substr(1);
+	}
+
+public:
+	SentimentPipeline(const SentimentEngine& engine, string field = "text", int threads = 0, int batchSize = 256)
+		: engine(engine), field(field), threads(threads), batchSize(batchSize) {
+		if (this->threads <= 0)
+			this->threads = max(1u, thread::hardware_concurrency());
+		if (this->batchSize <= 0)
+			this->batchSize = 1;
+	}
+
+
+	// Returns the number of input lines processed (blank lines are skipped)
+	long long run(istream& in, ostream& out) {
+		const long long window = threads * 4;
+		BoundedQueue<Batch> input(threads * 2);
+		BoundedQueue<Batch> output(window);
+		long long total = 0;
+
+		// Sequence number of the next batch the writer is waiting for
+		mutex progressLock;
+		condition_variable progress;
+		long long nextSequence = 0;
+
+		thread reader([&] {
+			Batch batch;
+			string line;
+			long long number = 0;
+			long long sequence = 0;
+
+			auto send = [&] {
+				{
+					unique_lock<mutex> guard(progressLock);
+					progress.wait(guard, [&] { return sequence < nextSequence + window; });
+				}
+				batch.sequence = sequence++;
+				input.push(move(batch));
+				batch = Batch();
+			};
+
+			while (getline(in, line)) {
+				number++;
+				if (line.find_first_not_of(" \t\r") == string::npos) continue;
+				batch.numbers.push_back(number);
+				batch.lines.push_back(move(line));
+				if ((int)batch.lines.size() == batchSize)
+					send();
+			}
+			if (!batch.lines.empty())
+				send();
+			input.close();
+		});
+
+		vector<thread> workers;
+		for (int t = 0; t < threads; t++) {
+			workers.emplace_back([&] {
+				Batch batch;
+				while (input.pop(batch)) {
+					for (size_t i = 0; i < batch.lines.size(); i++)
+						batch.lines[i] = scoreLine(batch.lines[i], batch.numbers[i]);
+					output.push(move(batch));
+				}
+			});
+		}
+
+		thread closer([&] {
+			for (auto& worker : workers)
+				worker.join();
+			output.close();
+		});
+
+		// Writer: batches may finish out of order, hold them until their turn
+		map<long long, Batch> pending;
+		Batch batch;
+		while (output.pop(batch)) {
+			pending.emplace(batch.sequence, move(batch));
+			while (!pending.empty() && pending.begin()->first == nextSequence) {
+				for (const auto& line : pending.begin()->second.lines)
+					out << line << '\n';
+				total += pending.begin()->second.lines.size();
+				pending.erase(pending.begin());
+
+				lock_guard<mutex> guard(progressLock);
+				nextSequence++;
+				progress.notify_one();
+			}
+		}
+		out.flush();
+
+		reader.join();
+		closer.join();
+		return total;
+	}
+};
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <fstream>
+#include <utility>
+
+#include "Csv_Reader.h"
+
+using namespace std;
+
+
+// Column
+// A read-only array that either owns its elements (built in memory) or
+// views them inside a mapped snapshot, so the same code serves both.
+template <class T>
+class Column {
+protected:
+	vector<T> owned;
+	const T* items = nullptr;
+	size_t count = 0;
+
+public:
+	Column() {}
+
+
+	Column(vector<T> values) : owned(move(values)), items(owned.data()), count(owned.size()) {}
+
+
+	Column(const Column& other) : owned(other.owned), items(other.owned.empty() ? other.items : owned.data()), count(other.count) {}
+
+
+	// Moving a vector keeps its buffer, so items stays valid
+	Column(Column&& other) noexcept : owned(move(other.owned)), items(other.items), count(other.count) {
+		other.items = nullptr;
+		other.count = 0;
+	}
+
+
+	Column& operator=(Column other) {
+		swap(owned, other.owned);
+		swap(items, other.items);
+		swap(count, other.count);
+		return *this;
+	}
+
+
+	// Views n elements owned by someone else (a mapped file)
+	void map(const T* p, size_t n) {
+		owned.clear();
+		owned.shrink_to_fit();
+		items = p;
+		count = n;
+	}
+
+
+	const T& operator[](size_t i) const { return items[i]; }
+
+
+	size_t size() const { return count; }
+
+
+	bool empty() const { return count == 0; }
+
+
+	const T* data() const { return items; }
+
+
+	const T* begin() const { return items; }
+
+
+	const T* end() const { return items + count; }
+
+
+	size_t bytes() const { return count * sizeof(T); }
+
+
+	// Checks for columns mapped from a snapshot, which must not be trusted
+	// to hold valid indices: every element within [low, high]
+	bool within(T low, T high) const {
+		for (size_t i = 0; i < count; i++) {
+			if (items[i] < low || items[i] > high) return false;
+		}
+		return true;
+	}
+
+
+	// Every element above (strict) or at least equal to the one before it
+	bool ascending(bool strict = false) const {
+		for (size_t i = 1; i < count; i++) {
+			if (items[i] < items[i - 1] || (strict && items[i] == items[i - 1])) return false;
+		}
+		return true;
+	}
+
+
+	// CSR offsets into total elements: non-empty, starting at 0, never
+	// decreasing and ending at total
+	bool partitions(size_t total) const {
+		return count > 0 && items[0] == 0 && size_t(items[count - 1]) == total && ascending();
+	}
+};
+
+
+// Every range values[starts[k] .. starts[k + 1]) strictly increasing;
+// starts must already partition values
+template <class S, class T>
+bool ascendingRanges(const Column<S>& starts, const Column<T>& values) {
+	for (size_t k = 0; k + 1 < starts.size(); k++) {
+		for (S i = starts[k] + 1; i < starts[k + 1]; i++) {
+			if (values[i] <= values[i - 1]) return false;
+		}
+	}
+	return true;
+}
+
+
+// Snapshot Writer
+// File layout: a header (magic, version, byte-order mark, 0), then one
+// section per column in a fixed order, each an element count and element
+// size (uint64, uint32, uint32 padding) followed by the raw elements,
+// padded to 8 bytes. Every section therefore starts 8-byte aligned and
+// can be used in place once the file is mapped.
+class SnapshotWriter {
+protected:
+	ofstream out;
+	uint64_t offset = 0;
+
+
+	void put(const void* p, size_t n) {
+		out.write((const char*)p, n);
+		offset += n;
+	}
+
+
+	void pad() {
+		static const char zeros[8] = {};
+		if (offset % 8) put(zeros, 8 - offset % 8);
+	}
+
+public:
+	static const uint32_t MAGIC = 0x4e53564d;	// "MVSN"
+	static const uint32_t VERSION = 7;
+	static const uint32_t ENDIAN_MARK = 0x01020304;
+
+
+	bool open(const string& path) {
+		out.open(path, ios::binary | ios::trunc);
+		if (!out) return false;
+		offset = 0;
+		uint32_t header[4] = { MAGIC, VERSION, ENDIAN_MARK, 0 };
+		put(header, sizeof(header));
+		return bool(out);
+	}
+
+
+	template <class T>
+	void write(const T* p, size_t n) {
+		uint64_t count = n;
+		uint32_t size[2] = { uint32_t(sizeof(T)), 0 };
+		put(&count, sizeof(count));
+		put(size, sizeof(size));
+		put(p, n * sizeof(T));
+		pad();
+	}
+
+
+	template <class T>
+	void write(const Column<T>& column) {
+		write(column.data(), column.size());
+	}
+
+
+	bool close() {
+		out.close();
+		return !out.fail();
+	}
+};
+
+
+// Snapshot Reader
+// Maps a snapshot and hands out its sections in the order they were
+// written. A bad header, a truncated section or an element size that does
+// not match marks the reader failed; later reads then return empty
+// columns, and good() reports the failure once at the end.
+class SnapshotReader {
+protected:
+	MappedFile file;
+	size_t offset = 0;
+	bool ok = false;
+
+public:
+	// False when the file is missing or not a snapshot of this version
+	bool open(const string& path) {
+		ok = false;
+		if (!file.open(path) || file.size() < 16) return false;
+		const uint32_t* header = (const uint32_t*)file.data();
+		if (header[0] != SnapshotWriter::MAGIC || header[1] != SnapshotWriter::VERSION || header[2] != SnapshotWriter::ENDIAN_MARK)
+			return false;
+		offset = 16;
+		ok = true;
+		return true;
+	}
+
+
+	template <class T>
+	void read(Column<T>& column) {
+		column.map(nullptr, 0);
+		if (!ok || file.size() - offset < 16) {
+			ok = false;
+			return;
+		}
+		uint64_t count = *(const uint64_t*)(file.data() + offset);
+		uint32_t size = *(const uint32_t*)(file.data() + offset + 8);
+		offset += 16;
+		uint64_t length = (count * sizeof(T) + 7) / 8 * 8;
+		if (size != sizeof(T) || count > file.size() || file.size() - offset < length) {
+			ok = false;
+			return;
+		}
+		column.map((const T*)(file.data() + offset), count);
+		offset += length;
+	}
+
+
+	// For callers that find the mapped data inconsistent
+	void fail() { ok = false; }
+
+
+	bool good() const { return ok; }
+};
+
+
+// String Column
+// Strings packed end to end in one arena: string i is
+// arena[offsets[i] .. offsets[i + 1]).
+class StringColumn {
+protected:
+	Column<char> arena;
+	Column<uint32_t> offsets;
+
+public:
+	StringColumn() {}
+
+
+	StringColumn(const vector<string_view>& values) {
+		vector<char> chars;
+		vector<uint32_t> starts(1, 0);
+		starts.reserve(values.size() + 1);
+		for (string_view v : values) {
+			chars.insert(chars.end(), v.begin(), v.end());
+			starts.push_back(chars.size());
+		}
+		arena = Column<char>(move(chars));
+		offsets = Column<uint32_t>(move(starts));
+	}
+
+
+	string_view operator[](size_t i) const {
+		return string_view(arena.data() + offsets[i], offsets[i + 1] - offsets[i]);
+	}
+
+
+	size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+
+	size_t bytes() const { return arena.bytes() + offsets.bytes(); }
+
+
+	void save(SnapshotWriter& out) const {
+		out.write(arena);
+		out.write(offsets);
+	}
+
+
+	// Maps the columns and checks that every string lies in the arena
+	void map(SnapshotReader& in) {
+		in.read(arena);
+		in.read(offsets);
+		if (!in.good()) return;
+		if (!offsets.partitions(arena.size())) {
+			arena.map(nullptr, 0);
+			offsets.map(nullptr, 0);
+			in.fail();
+		}
+	}
+};
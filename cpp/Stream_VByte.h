@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+using namespace std;
+
+
+// Stream VByte
+// Integer compression of Lemire, Kurz and Rybaczynski: each 32-bit value
+// takes 1-4 bytes, and the byte lengths are kept apart from the data as
+// 2-bit codes, four to a control byte. One control byte describes exactly
+// 16 or fewer data bytes, so with SSSE3 a decoder loads 16 bytes, expands
+// them into four integers with a single shuffle chosen by the control byte
+// and moves on by a looked-up length: no branch per value.
+//
+// Layout of n values: (n + 3) / 4 control bytes, then the data bytes. The
+// SIMD decoder reads up to 16 bytes past the data it uses; callers keep
+// PADDING readable bytes after every encoded stream.
+class StreamVByte {
+protected:
+	static int bytesOf(uint32_t v) {
+		return v < (1u << 8) ? 1 : v < (1u << 16) ? 2 : v < (1u << 24) ? 3 : 4;
+	}
+
+
+	// Data bytes used by a control byte
+	static constexpr array<uint8_t, 256> LENGTHS = [] {
+		array<uint8_t, 256> table{};
+		for (int c = 0; c < 256; c++)
+			table[c] = 4 + (c & 3) + ((c >> 2) & 3) + ((c >> 4) & 3) + ((c >> 6) & 3);
+		return table;
+	}();
+
+
+	// pshufb masks spreading a control byte's data into four 32-bit lanes
+	// (0x80 writes a zero byte)
+	static constexpr array<array<uint8_t, 16>, 256> SHUFFLES = [] {
+		array<array<uint8_t, 16>, 256> table{};
+		for (int c = 0; c < 256; c++) {
+			int source = 0;
+			for (int lane = 0; lane < 4; lane++) {
+				int length = ((c >> (2 * lane)) & 3) + 1;
+				for (int b = 0; b < 4; b++)
+					table[c][lane * 4 + b] = b < length ? source++ : 0x80;
+			}
+		}
+		return table;
+	}();
+
+public:
+	static const int PADDING = 16;
+
+
+	// Appends the encoding of n values
+	static void encode(const uint32_t* values, size_t n, vector<uint8_t>& out) {
+		size_t control = out.size();
+		out.resize(out.size() + (n + 3) / 4, 0);
+		for (size_t i = 0; i < n; i++) {
+			int length = bytesOf(values[i]);
+			out[control + i / 4] |= (length - 1) << (2 * (i % 4));
+			for (int b = 0; b < length; b++)
+				out.push_back(values[i] >> (8 * b));
+		}
+	}
+
+
+	// Bytes taken by the encoding of n values at in, read from its control
+	// bytes alone; lets a caller check untrusted data before decoding it
+	static size_t encodedSize(const uint8_t* in, size_t n) {
+		size_t size = (n + 3) / 4;
+		for (size_t i = 0; i < n; i++)
+			size += ((in[i / 4] >> (2 * (i % 4))) & 3) + 1;
+		return size;
+	}
+
+
+	// Decodes n values; returns the end of the data used
+	static const uint8_t* decode(const uint8_t* in, size_t n, uint32_t* values) {
+		const uint8_t* control = in;
+		const uint8_t* data = in + (n + 3) / 4;
+		size_t i = 0;
+#ifdef __SSSE3__
+		for (; i + 4 <= n; i += 4) {
+			uint8_t c = control[i / 4];
+			__m128i bytes = _mm_loadu_si128((const __m128i*)data);
+			__m128i shuffle = _mm_loadu_si128((const __m128i*)SHUFFLES[c].data());
+			_mm_storeu_si128((__m128i*)(values + i), _mm_shuffle_epi8(bytes, shuffle));
+			data += LENGTHS[c];
+		}
+#endif
+		for (; i < n; i++) {
+			int length = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+			uint32_t v = 0;
+			for (int b = 0; b < length; b++)
+				v |= uint32_t(data[b]) << (8 * b);
+			values[i] = v;
+			data += length;
+		}
+		return data;
+	}
+};
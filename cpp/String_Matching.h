@@ -0,0 +1,1173 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <array>
+#include <utility>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Text_Index.h"
+#include "Suffix_Array.h"
+#include "FM_Index.h"
+#include "Suffix_Automaton.h"
+
+using namespace std;
+
+
+// Case folding tables (A-Z to a-z), indexed by unsigned byte. The
+// case-insensitive mode folds text bytes through FOLD_CASE inside the search
+// loops, so the text itself is never copied or lowercased.
+inline constexpr array<unsigned char, 256> SAME_CASE = [] {
+	array<unsigned char, 256> table{};
+	for (int c = 0; c < 256; c++)
+		table[c] = c;
+	return table;
+}();
+
+inline constexpr array<unsigned char, 256> FOLD_CASE = [] {
+	array<unsigned char, 256> table = SAME_CASE;
+	for (int c = 'A'; c <= 'Z'; c++)
+		table[c] = c - 'A' + 'a';
+	return table;
+}();
+
+
+// Compile-time pattern literal, usable as a template argument:
+// text.find<"ERROR">() (requires C++20)
+template <size_t N>
+struct FixedString {
+	char chars[N] = {};
+
+	constexpr FixedString(const char (&str)[N]) {
+		for (size_t i = 0; i < N; i++)
+			chars[i] = str[i];
+	}
+
+	constexpr int length() const { return N - 1; }
+};
+
+
+// Preprocessing of a FixedString, evaluated entirely by the compiler:
+// the Horspool shift table, the KMP LPS array and the Shift-And masks.
+// With IGNORE_CASE the pattern is folded and the tables cover both cases.
+template <FixedString P, bool IGNORE_CASE = false>
+struct CompiledPattern {
+	static constexpr int m = P.length();
+
+	static constexpr unsigned char key(char c) {
+		return IGNORE_CASE ? FOLD_CASE[(unsigned char)c] : (unsigned char)c;
+	}
+
+	static constexpr array<unsigned char, (m > 0 ? m : 1)> chars = [] {
+		array<unsigned char, (m > 0 ? m : 1)> folded{};
+		for (int i = 0; i < m; i++)
+			folded[i] = key(P.chars[i]);
+		return folded;
+	}();
+
+	static constexpr array<int, 256> shift = [] {
+		array<int, 256> byKey{};
+		for (int c = 0; c < 256; c++)
+			byKey[c] = m;
+		for (int i = 0; i < m - 1; i++)
+			byKey[chars[i]] = m - 1 - i;
+		array<int, 256> table{};
+		for (int c = 0; c < 256; c++)
+			table[c] = byKey[key(c)];
+		return table;
+	}();
+
+	static constexpr array<int, (m > 0 ? m : 1)> lps = [] {
+		array<int, (m > 0 ? m : 1)> table{};
+		int i = 1, len = 0;
+		while (i < m) {
+			if (chars[i] == chars[len])
+				table[i++] = ++len;
+			else if (len != 0)
+				len = table[len - 1];
+			else
+				table[i++] = 0;
+		}
+		return table;
+	}();
+
+	static constexpr array<uint64_t, 256> masks = [] {
+		array<uint64_t, 256> table{};
+		for (int c = 0; c < 256; c++) {
+			for (int i = 0; i < m && i < 64; i++) {
+				if (key(c) == chars[i])
+					table[c] |= uint64_t(1) << i;
+			}
+		}
+		return table;
+	}();
+
+	// Compares the window at s with the pattern, fully unrolled from the
+	// last byte backwards (the byte Horspool has just looked at)
+	static bool equals(const char* s) {
+		return [&]<size_t... J>(index_sequence<J...>) {
+			return ((key(s[m - 1 - J]) == chars[m - 1 - J]) && ...);
+		}(make_index_sequence<m>{});
+	}
+};
+
+
+// KMP Automaton
+// Compiles a pattern into a full DFA over byte classes (every byte that does
+// not occur in the pattern shares class 0). State j is the length of the
+// currently matched prefix, so each text byte costs exactly one table lookup
+// and the search never backtracks. The state survives between feed() calls,
+// which lets a stream be scanned chunk by chunk.
+class KMPAutomaton {
+protected:
+	int m = 0;
+	int classes = 1;
+	unsigned char byteClass[256] = {};
+	vector<int> table;
+	int state = 0;
+	long long consumed = 0;
+
+public:
+	// With ignoreCase both cases of a letter share one byte class, so the
+	// case-insensitive automaton is exactly as fast as the exact one
+	KMPAutomaton(string pattern, bool ignoreCase = false) {
+		m = pattern.length();
+		if (ignoreCase) {
+			for (char& c : pattern)
+				c = FOLD_CASE[(unsigned char)c];
+		}
+		for (int i = 0; i < m; i++) {
+			unsigned char c = pattern[i];
+			if (byteClass[c] == 0)
+				byteClass[c] = classes++;
+		}
+		if (ignoreCase) {
+			for (int c = 'A'; c <= 'Z'; c++)
+				byteClass[c] = byteClass[c - 'A' + 'a'];
+		}
+
+		table.assign((m + 1) * classes, 0);
+		if (m == 0) return;
+
+		// Row j copies the row of its failure state X, then overrides the
+		// transition on pattern[j]; X follows the pattern through the DFA.
+		table[byteClass[(unsigned char)pattern[0]]] = 1;
+		int x = 0;
+		for (int j = 1; j <= m; j++) {
+			for (int c = 0; c < classes; c++)
+				table[j * classes + c] = table[x * classes + c];
+			if (j < m) {
+				int c = byteClass[(unsigned char)pattern[j]];
+				table[j * classes + c] = j + 1;
+				x = table[x * classes + c];
+			}
+		}
+	}
+
+
+	void reset() {
+		state = 0;
+		consumed = 0;
+	}
+
+
+	// Scans the next chunk of the stream and appends the start offsets
+	// (relative to the whole stream) of every match that ends inside it.
+	void feed(const char* data, int size, vector<long long>& found_in) {
+		if (m == 0) return;
+
+		// Matches are written branch-free into a block-sized buffer, the
+		// cursor only advances when the automaton reaches the accept state.
+		const int BLOCK = 4096;
+		long long hits[BLOCK];
+		const int* t = table.data();
+		int s = state;
+
+		for (int start = 0; start < size; start += BLOCK) {
+			int end = min(size, start + BLOCK);
+			int count = 0;
+			for (int i = start; i < end; i++) {
+				s = t[s * classes + byteClass[(unsigned char)data[i]]];
+				hits[count] = consumed + i - m + 1;
+				count += (s == m);
+			}
+			found_in.insert(found_in.end(), hits, hits + count);
+		}
+
+		state = s;
+		consumed += size;
+	}
+};
+
+
+
+// One approximate match: offset of its last byte and its edit distance
+struct ApproximateMatch {
+	int end;
+	int distance;
+};
+
+
+// Myers' Bit-vector Algorithm
+// k-differences search: reports every text offset where some substring
+// ending there is within edit distance k of the pattern. Column j of the
+// edit-distance matrix is kept as bit vectors of its vertical +1/-1 deltas
+// (Pv, Mv), updated with a handful of word operations per text byte, so a
+// pattern of up to 64 bytes costs about as much as a Shift-And scan. Longer
+// patterns are split into 64-bit blocks that pass their horizontal delta
+// (-1, 0, +1) up to the next block, as in Myers' paper.
+class MyersMatcher {
+protected:
+	int m = 0;
+	int blocks = 0;
+	// peq[c * blocks + b]: bit i set when pattern[64 * b + i] matches c
+	vector<uint64_t> peq;
+
+public:
+	MyersMatcher(string pattern, bool ignoreCase = false) {
+		m = pattern.length();
+		blocks = (m + 63) / 64;
+		peq.assign(256 * blocks, 0);
+		for (int i = 0; i < m; i++) {
+			unsigned char c = pattern[i];
+			uint64_t bit = uint64_t(1) << (i % 64);
+			if (ignoreCase) {
+				c = FOLD_CASE[c];
+				if (c >= 'a' && c <= 'z')
+					peq[(c - 'a' + 'A') * blocks + i / 64] |= bit;
+			}
+			peq[c * blocks + i / 64] |= bit;
+		}
+	}
+
+
+	int length() const { return m; }
+
+
+	void search(const char* text, int n, int k, vector<ApproximateMatch>& found) const {
+		if (m == 0) return;
+		if (blocks == 1) {
+			const uint64_t high = uint64_t(1) << (m - 1);
+			uint64_t pv = ~uint64_t(0), mv = 0;
+			int score = m;
+			for (int j = 0; j < n; j++) {
+				uint64_t eq = peq[(unsigned char)text[j]];
+				uint64_t xv = eq | mv;
+				uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+				uint64_t ph = mv | ~(xh | pv);
+				uint64_t mh = pv & xh;
+				score += ((ph & high) != 0) - ((mh & high) != 0);
+				// Row 0 is all zeros while searching: no carry into bit 0
+				ph <<= 1;
+				mh <<= 1;
+				pv = mh | ~(xv | ph);
+				mv = ph & xv;
+				if (score <= k)
+					found.push_back({ j, score });
+			}
+			return;
+		}
+
+		vector<uint64_t> pv(blocks, ~uint64_t(0)), mv(blocks, 0);
+		const uint64_t top = uint64_t(1) << 63;
+		const uint64_t high = uint64_t(1) << ((m - 1) % 64);
+		int score = m;
+		for (int j = 0; j < n; j++) {
+			const uint64_t* column = &peq[(unsigned char)text[j] * blocks];
+			int carry = 0;
+			for (int b = 0; b < blocks; b++) {
+				uint64_t eq = column[b];
+				uint64_t xv = eq | mv[b];
+				if (carry < 0) eq |= 1;
+				uint64_t xh = (((eq & pv[b]) + pv[b]) ^ pv[b]) | eq;
+				uint64_t ph = mv[b] | ~(xh | pv[b]);
+				uint64_t mh = pv[b] & xh;
+				uint64_t out = b == blocks - 1 ? high : top;
+				int next = ((ph & out) != 0) - ((mh & out) != 0);
+				ph <<= 1;
+				mh <<= 1;
+				if (carry < 0) mh |= 1;
+				else if (carry > 0) ph |= 1;
+				pv[b] = mh | ~(xv | ph);
+				mv[b] = ph & xv;
+				carry = next;
+			}
+			score += carry;
+			if (score <= k)
+				found.push_back({ j, score });
+		}
+	}
+
+
+	// Edit distance between the pattern and the whole text (Hyyrö's global
+	// variant: row 0 grows by one per column, a carry of +1 into bit 0).
+	// With transpositions, swapping two adjacent bytes costs 1 (optimal
+	// string alignment distance, Hyyrö's Damerau extension: a diagonal zero
+	// also arises where the previous column had none and the two bytes
+	// match crosswise). Stops as soon as the distance must exceed limit and
+	// returns limit + 1.
+	int distance(const char* text, int n, int limit = INT_MAX, bool transpositions = false) const {
+		if (m == 0) return n > limit ? limit + 1 : n;
+		if (abs(m - n) > limit) return limit + 1;
+		int score = m;
+		if (blocks == 1) {
+			const uint64_t high = uint64_t(1) << (m - 1);
+			uint64_t pv = ~uint64_t(0), mv = 0, d0 = 0, last = 0;
+			for (int j = 0; j < n; j++) {
+				uint64_t eq = peq[(unsigned char)text[j]];
+				uint64_t tr = transpositions ? ((~d0 & eq) << 1) & last : 0;
+				last = eq;
+				d0 = ((((eq & pv) + pv) ^ pv) | eq) | mv | tr;
+				uint64_t ph = mv | ~(d0 | pv);
+				uint64_t mh = pv & d0;
+				score += ((ph & high) != 0) - ((mh & high) != 0);
+				ph = (ph << 1) | 1;
+				mh <<= 1;
+				pv = mh | ~(d0 | ph);
+				mv = ph & d0;
+				// The score drops by at most one per remaining column
+				if (score - (n - 1 - j) > limit) return limit + 1;
+			}
+			return score;
+		}
+
+		vector<uint64_t> pv(blocks, ~uint64_t(0)), mv(blocks, 0), d0(blocks, 0), last(blocks, 0);
+		const uint64_t top = uint64_t(1) << 63;
+		const uint64_t high = uint64_t(1) << ((m - 1) % 64);
+		for (int j = 0; j < n; j++) {
+			const uint64_t* column = &peq[(unsigned char)text[j] * blocks];
+			int carry = 1;
+			uint64_t shifted = 0;
+			for (int b = 0; b < blocks; b++) {
+				uint64_t eq = column[b];
+				uint64_t cross = ~d0[b] & eq;
+				uint64_t tr = transpositions ? ((cross << 1) | shifted) & last[b] : 0;
+				shifted = cross >> 63;
+				last[b] = eq;
+				if (carry < 0) eq |= 1;
+				d0[b] = ((((eq & pv[b]) + pv[b]) ^ pv[b]) | eq) | mv[b] | tr;
+				uint64_t ph = mv[b] | ~(d0[b] | pv[b]);
+				uint64_t mh = pv[b] & d0[b];
+				uint64_t out = b == blocks - 1 ? high : top;
+				int next = ((ph & out) != 0) - ((mh & out) != 0);
+				ph <<= 1;
+				mh <<= 1;
+				if (carry < 0) mh |= 1;
+				else if (carry > 0) ph |= 1;
+				pv[b] = mh | ~(d0[b] | ph);
+				mv[b] = ph & d0[b];
+				carry = next;
+			}
+			score += carry;
+			if (score - (n - 1 - j) > limit) return limit + 1;
+		}
+		return score;
+	}
+};
+
+
+
+class StringMatching {
+protected:
+	string text;
+	bool wholeWord = false;
+	bool ignoreCase = false;
+	// SAME_CASE or FOLD_CASE, depending on ignoreCase
+	const unsigned char* fold = SAME_CASE.data();
+	// Built on first use by the offset translation methods
+	Utf8Index utf8;
+	LineIndex lineIndex;
+	// Built on first use (or loaded) by the suffix array searches
+	SuffixArray suffixIndex;
+	FMIndex compressedIndex;
+	int fmSampleRate = 32;
+	SuffixAutomaton automaton;
+	// Threads used to build the suffix array and FM-index
+	int indexThreads = 1;
+
+
+	char folded(char c) const {
+		return fold[(unsigned char)c];
+	}
+
+
+	string foldPattern(string pattern) const {
+		for (char& c : pattern)
+			c = folded(c);
+		return pattern;
+	}
+
+
+	// Whole-word Mode
+	// Bytes that separate words: whitespace and the punctuation findMatches()
+	// in js/sentiment.js accepts ([\s.,!?;:'"()\[\]{}\-]). The text edges
+	// count as boundaries too. Every search checks this where it confirms a
+	// match, instead of filtering the result list afterwards.
+	static constexpr array<bool, 256> BOUNDARY = [] {
+		array<bool, 256> table{};
+		for (const char* p = " \t\n\v\f\r.,!?;:'\"()[]{}-"; *p; p++)
+			table[(unsigned char)*p] = true;
+		return table;
+	}();
+
+	static bool wordBounded(string_view text, int start, int m) {
+		int end = start + m;
+		return (start == 0 || BOUNDARY[(unsigned char)text[start - 1]])
+			&& (end >= (int)text.length() || BOUNDARY[(unsigned char)text[end]]);
+	}
+
+	bool acceptMatch(int start, int m) const {
+		return !wholeWord || wordBounded(text, start, m);
+	}
+
+
+	// Rabin-Karp Algorithm (Hashing)
+	long long hashing(string chars, int c, long long old_hash = 0) {
+		int size = (int)chars.length();
+		static int prefix;
+		long long hash = 0;
+		if (c == 0) {
+			prefix = int(char(chars[0])) * pow(101, size - 1);
+			hash += prefix;
+			for (int i = 2; i <= size; i++) {
+				hash += int(char(chars[i - 1])) * pow(101, size - i);
+			}
+		}
+		else {
+			hash = (101 * (old_hash - prefix)) + int(char(chars[size - 1]));
+			prefix = int(char(chars[0])) * pow(101, size - 1);
+		}
+		return hash;
+	}
+
+
+	unordered_map<char, int> horspoolHelper(string pattern) {
+		unordered_map<char, int> values;
+		int len = pattern.length();
+
+		for (int i = 0; i < len; i++) {
+			if (i == len - 1) {
+				if (values.find(char(pattern[i])) == values.end()) {
+					values[char(pattern[i])] = len;
+					continue;
+				}
+				else { continue; }
+			}
+			values[char(pattern[i])] = len - i - 1;
+		}
+
+		return values;
+	}
+
+
+	// Short Pattern Kernels (m <= 8)
+	// Patterns this short gain nothing from shift tables or failure links, so
+	// every public search dispatches here first. m == 1 is a plain memchr;
+	// otherwise candidates are found by comparing the first and last pattern
+	// bytes 16 positions at a time (SSE2), then confirmed with 16/32/64-bit
+	// loads of the text against the same loads of the pattern.
+	static const int SHORT_PATTERN = 8;
+
+	static bool equalsShort(const char* s, const char* p, int m) {
+		uint16_t a16, b16;
+		uint32_t a32, b32, c32, d32;
+		uint64_t a64, b64;
+
+		switch (m) {
+		case 2:
+			memcpy(&a16, s, 2); memcpy(&b16, p, 2);
+			return a16 == b16;
+		case 3:
+			memcpy(&a16, s, 2); memcpy(&b16, p, 2);
+			return a16 == b16 && s[2] == p[2];
+		case 4:
+			memcpy(&a32, s, 4); memcpy(&b32, p, 4);
+			return a32 == b32;
+		case 8:
+			memcpy(&a64, s, 8); memcpy(&b64, p, 8);
+			return a64 == b64;
+		default:
+			// 5..7 bytes: two overlapping 32-bit words cover the pattern
+			memcpy(&a32, s, 4); memcpy(&b32, p, 4);
+			memcpy(&c32, s + m - 4, 4); memcpy(&d32, p + m - 4, 4);
+			return a32 == b32 && c32 == d32;
+		}
+	}
+
+
+	// Case-insensitive helpers: 16 bytes folded at once with SSE2 (bytes in
+	// 'A'..'Z' are moved to the bottom of the signed range and compared), 8
+	// bytes at once with the equivalent SWAR arithmetic on a 64-bit word
+#ifdef __SSE2__
+	static __m128i foldBlock(__m128i x) {
+		__m128i shifted = _mm_add_epi8(x, _mm_set1_epi8((char)(0x80 - 'A')));
+		__m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(0x80 + 26)));
+		return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+	}
+#endif
+
+	static uint64_t foldWord(uint64_t w) {
+		const uint64_t ones = 0x0101010101010101ULL;
+		uint64_t heptets = w & (0x7F * ones);
+		uint64_t atLeastA = heptets + (0x80 - 'A') * ones;
+		uint64_t aboveZ = heptets + (0x7F - 'Z') * ones;
+		uint64_t upper = (atLeastA ^ aboveZ) & ~w & (0x80 * ones);
+		return w | (upper >> 2);
+	}
+
+
+	// p is already folded; s is folded on the fly
+	static bool equalsShortFolded(const char* s, const char* p, int m) {
+		uint64_t a = 0, b = 0;
+		memcpy(&a, s, m);
+		memcpy(&b, p, m);
+		return foldWord(a) == b;
+	}
+
+
+	vector<int> searchShortFolded(const char* pattern, int m) {
+		vector<int> found_in;
+		int n = text.length();
+		char p[SHORT_PATTERN];
+		for (int k = 0; k < m; k++)
+			p[k] = FOLD_CASE[(unsigned char)pattern[k]];
+
+		int last = n - m;
+		int i = 0;
+		const char* s = text.data();
+
+#ifdef __SSE2__
+		const __m128i first = _mm_set1_epi8(p[0]);
+		const __m128i last_byte = _mm_set1_epi8(p[m - 1]);
+
+		for (; i + 16 <= last + 1; i += 16) {
+			__m128i a = foldBlock(_mm_loadu_si128((const __m128i*)(s + i)));
+			__m128i b = foldBlock(_mm_loadu_si128((const __m128i*)(s + i + m - 1)));
+			unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last_byte)));
+
+			while (mask != 0) {
+				int bit = __builtin_ctz(mask);
+				if ((m <= 2 || equalsShortFolded(s + i + bit, p, m)) && acceptMatch(i + bit, m))
+					found_in.push_back(i + bit);
+				mask &= mask - 1;
+			}
+		}
+#endif
+
+		for (; i <= last; i++) {
+			if (FOLD_CASE[(unsigned char)s[i]] == (unsigned char)p[0] && equalsShortFolded(s + i, p, m) && acceptMatch(i, m))
+				found_in.push_back(i);
+		}
+
+		return found_in;
+	}
+
+
+	vector<int> searchShort(const char* p, int m) {
+		vector<int> found_in;
+		int n = text.length();
+		if (m == 0 || m > n) return found_in;
+
+		// Folding only matters when the pattern has letters
+		if (ignoreCase) {
+			for (int k = 0; k < m; k++) {
+				unsigned char c = p[k] | 0x20;
+				if (c >= 'a' && c <= 'z')
+					return searchShortFolded(p, m);
+			}
+		}
+
+		const char* s = text.data();
+
+		if (m == 1) {
+			const char* at = s;
+			const char* end = s + n;
+			while ((at = (const char*)memchr(at, p[0], end - at)) != nullptr) {
+				if (acceptMatch(at - s, 1))
+					found_in.push_back(at - s);
+				at++;
+			}
+			return found_in;
+		}
+
+		int last = n - m;
+		int i = 0;
+
+#ifdef __SSE2__
+		const __m128i first = _mm_set1_epi8(p[0]);
+		const __m128i last_byte = _mm_set1_epi8(p[m - 1]);
+
+		// Block loads read s[i .. i + m + 14], which stays inside the text
+		for (; i + 16 <= last + 1; i += 16) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(s + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(s + i + m - 1));
+			unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last_byte)));
+
+			while (mask != 0) {
+				int bit = __builtin_ctz(mask);
+				if (equalsShort(s + i + bit, p, m) && acceptMatch(i + bit, m))
+					found_in.push_back(i + bit);
+				mask &= mask - 1;
+			}
+		}
+#endif
+
+		// Scalar tail (and the whole text without SSE2): memchr to the next
+		// occurrence of the first byte, then the integer compare
+		while (i <= last) {
+			const char* at = (const char*)memchr(s + i, p[0], last + 1 - i);
+			if (at == nullptr) break;
+			i = at - s;
+			if (equalsShort(at, p, m) && acceptMatch(i, m))
+				found_in.push_back(i);
+			i++;
+		}
+
+		return found_in;
+	}
+
+public:
+	StringMatching(string txt) {
+		text = txt;
+	}
+
+
+	// Only report matches that are whole words (see BOUNDARY)
+	void setWholeWord(bool enabled) {
+		wholeWord = enabled;
+	}
+
+
+	// Match ASCII letters regardless of case (see FOLD_CASE)
+	void setIgnoreCase(bool enabled) {
+		ignoreCase = enabled;
+		fold = enabled ? FOLD_CASE.data() : SAME_CASE.data();
+	}
+
+
+	// UTF-8 Offsets
+	// The JS front end highlights by UTF-16 index; these translate the byte
+	// offsets returned by the searches (see Utf8Index).
+	const Utf8Index& utf8Index() {
+		if (utf8.text() != text.data())
+			utf8 = Utf8Index(text.data(), text.length());
+		return utf8;
+	}
+
+
+	bool validUtf8() {
+		return utf8Index().valid();
+	}
+
+
+	vector<int> utf16Offsets(const vector<int>& found_in) {
+		const Utf8Index& index = utf8Index();
+		vector<int> offsets;
+		offsets.reserve(found_in.size());
+		for (int at : found_in)
+			offsets.push_back(index.utf16Offset(at));
+		return offsets;
+	}
+
+
+	vector<int> codePointOffsets(const vector<int>& found_in) {
+		const Utf8Index& index = utf8Index();
+		vector<int> offsets;
+		offsets.reserve(found_in.size());
+		for (int at : found_in)
+			offsets.push_back(index.codePointOffset(at));
+		return offsets;
+	}
+
+
+	// 1-based (row, column) of every match, as computeRowCol() in
+	// js/script.js reports them (columns in UTF-16 units)
+	vector<pair<int, int>> rowCol(const vector<int>& found_in) {
+		if (lineIndex.text() != text.data())
+			lineIndex = LineIndex(text.data(), text.length());
+		const Utf8Index& index = utf8Index();
+
+		vector<pair<int, int>> positions;
+		positions.reserve(found_in.size());
+		for (int at : found_in) {
+			size_t line = lineIndex.lineOf(at);
+			size_t start = lineIndex.lineStart(line);
+			positions.push_back({ int(line + 1), int(index.utf16Offset(at) - index.utf16Offset(start) + 1) });
+		}
+		return positions;
+	}
+
+
+	// Suffix Array Index
+	// For many patterns against the same text: the index is built once (or
+	// loaded from disk), then every search is two binary searches over the
+	// suffixes instead of a scan of the text (see SuffixArray).
+	// Builds the indexes on this many threads (0: one per core)
+	void setIndexThreads(int threads) {
+		indexThreads = threads > 0 ? threads : max(1u, thread::hardware_concurrency());
+	}
+
+
+	const SuffixArray& suffixArray() {
+		if (suffixIndex.text() != text.data() || suffixIndex.ignoresCase() != ignoreCase)
+			suffixIndex = SuffixArray(text.data(), text.length(), ignoreCase, indexThreads);
+		return suffixIndex;
+	}
+
+
+	bool saveSuffixArray(const string& path) {
+		return suffixArray().save(path);
+	}
+
+
+	// False when the file does not belong to this text; the index is then
+	// rebuilt on the next search
+	bool loadSuffixArray(const string& path) {
+		return suffixIndex.load(path, text.data(), text.length());
+	}
+
+
+	vector<int> searchSuffixArray(string pattern) {
+		vector<int> found_in = suffixArray().locate(pattern);
+		if (wholeWord) {
+			int m = pattern.length();
+			found_in.erase(remove_if(found_in.begin(), found_in.end(), [&](int at) { return !acceptMatch(at, m); }), found_in.end());
+		}
+		return found_in;
+	}
+
+
+	int countSuffixArray(string pattern) {
+		if (wholeWord)
+			return searchSuffixArray(pattern).size();
+		return suffixArray().count(pattern);
+	}
+
+
+	// FM-index
+	// The compressed alternative to the suffix array (see FMIndex): counting
+	// never reads the text, locating costs up to fmSampleRate LF steps per
+	// occurrence.
+	void setFMSampleRate(int rate) {
+		fmSampleRate = max(1, rate);
+	}
+
+
+	const FMIndex& fmIndex() {
+		if (compressedIndex.text() != text.data() || compressedIndex.ignoresCase() != ignoreCase || compressedIndex.samplingRate() != fmSampleRate)
+			compressedIndex = FMIndex(text.data(), text.length(), ignoreCase, fmSampleRate, indexThreads);
+		return compressedIndex;
+	}
+
+
+	vector<int> searchFMIndex(string pattern) {
+		vector<int> found_in = fmIndex().locate(pattern);
+		if (wholeWord) {
+			int m = pattern.length();
+			found_in.erase(remove_if(found_in.begin(), found_in.end(), [&](int at) { return !acceptMatch(at, m); }), found_in.end());
+		}
+		return found_in;
+	}
+
+
+	int countFMIndex(string pattern) {
+		if (wholeWord)
+			return searchFMIndex(pattern).size();
+		return fmIndex().count(pattern);
+	}
+
+
+	// Suffix Automaton
+	// Substring queries that need no positions (see SuffixAutomaton): each
+	// costs O(pattern length) once the automaton is built.
+	const SuffixAutomaton& suffixAutomaton() {
+		if (automaton.text() != text.data() || automaton.ignoresCase() != ignoreCase)
+			automaton = SuffixAutomaton(text.data(), text.length(), ignoreCase);
+		return automaton;
+	}
+
+
+	bool occurs(string pattern) {
+		if (wholeWord)
+			return !searchKMP(pattern).empty();
+		return suffixAutomaton().occurs(pattern);
+	}
+
+
+	long long countOccurrences(string pattern) {
+		if (wholeWord)
+			return searchKMP(pattern).size();
+		return suffixAutomaton().count(pattern);
+	}
+
+
+	// Longest substring this text shares with another document (duplicate
+	// content detection)
+	CommonSubstring longestCommonSubstring(const string& other) {
+		return suffixAutomaton().longestCommonSubstring(other.data(), other.length());
+	}
+
+
+	// Approximate Matching
+	// Every offset where a substring of the text ending there is within
+	// maxDistance edits (insertions, deletions, substitutions) of the pattern,
+	// with its distance (see MyersMatcher). Neighbouring offsets usually match
+	// too, one edit further away. The whole-word mode does not apply, an
+	// approximate match has no single start.
+	vector<ApproximateMatch> searchApproximate(string pattern, int maxDistance) {
+		MyersMatcher matcher(pattern, ignoreCase);
+		vector<ApproximateMatch> found;
+		matcher.search(text.data(), text.length(), maxDistance, found);
+		return found;
+	}
+
+
+	vector<int> naiveStringMatching(string pattern) {
+		if (pattern.length() <= SHORT_PATTERN)
+			return searchShort(pattern.data(), pattern.length());
+
+		pattern = foldPattern(pattern);
+		char* ptr_s = &text[0];
+		char* ptr_f = &pattern[0];
+
+		vector<int> found_in;
+
+		for (int i = 0; i < text.size(); i++) {
+			if (folded(*ptr_s) == *ptr_f) {
+				if (ptr_f == &pattern[int(pattern.size() - 1)]) {
+					if (acceptMatch(i - (pattern.size() - 1), pattern.size()))
+						found_in.push_back(i - (pattern.size() - 1));
+					ptr_s += 1;
+					ptr_f = &pattern[0];
+				}
+				else {
+					ptr_s += 1;
+					ptr_f += 1;
+				}
+			}
+			else if (folded(*ptr_s) != *ptr_f) {
+				ptr_s += 1;
+				ptr_f = &pattern[0];
+			}
+		}
+		return found_in;
+	}
+
+
+
+	vector<int> rabinKarp(string pattern) {
+		if (pattern.length() <= SHORT_PATTERN)
+			return searchShort(pattern.data(), pattern.length());
+
+		pattern = foldPattern(pattern);
+		long long pattern_hash = hashing(pattern, 0);
+		int pattern_size = pattern.length();
+		vector<int> found_in;
+		long long word_hash;
+		int start = 0;
+
+		do {
+			string word = "";
+			for (int i = 0; i < pattern_size; i++) {
+				word += folded(text[i + start]);
+			}
+
+			if (!start)
+				word_hash = hashing(word, start);
+			else word_hash = hashing(word, start, word_hash);
+
+			if (word_hash == pattern_hash) {
+				if (word == pattern && acceptMatch(start, pattern_size)) {
+					found_in.push_back(start);
+				}
+			}
+			start++;
+		} while (start <= (text.length() - pattern_size));
+
+		return found_in;
+	}
+
+
+	// KMP Algorithm
+	// KMP Algorithm Helper Function
+	// Public for callers of findFolded()
+	static vector<int> computeLPS(string_view pattern) {
+		int i = 1, len = 0, m = pattern.length();
+		vector<int> lps(m, 0);
+
+		while (i < m) {
+			if (pattern[i] == pattern[len]) {
+				len++;
+				lps[i] = len;
+				i++;
+			}
+			else {
+				if (len != 0) {
+					len = lps[len - 1];
+				}
+				else {
+					lps[i] = 0;
+					i++;
+				}
+			}
+		}
+		return lps;
+	}
+
+
+	// Case-insensitive KMP over a caller's buffer, for callers that test
+	// one pattern against many short texts and should not build a
+	// StringMatching for each: pattern is already folded (FOLD_CASE) and
+	// lps = computeLPS(pattern). Returns the first match, -1 for none.
+	static int findFolded(string_view text, string_view pattern, const vector<int>& lps) {
+		int n = text.length(), m = pattern.length();
+		if (m == 0) return 0;
+		for (int i = 0, j = 0; i < n; i++) {
+			unsigned char c = FOLD_CASE[(unsigned char)text[i]];
+			while (j > 0 && c != (unsigned char)pattern[j])
+				j = lps[j - 1];
+			if (c == (unsigned char)pattern[j]) j++;
+			if (j == m) return i - m + 1;
+		}
+		return -1;
+	}
+
+
+	vector<int> searchKMP(string pattern) {
+		if (pattern.length() <= SHORT_PATTERN)
+			return searchShort(pattern.data(), pattern.length());
+
+		pattern = foldPattern(pattern);
+		vector<int> found_in;
+		int m = text.length();
+		int n = pattern.length();
+		vector<int> lps = computeLPS(pattern);
+		int i = 0, j = 0;
+
+		while (i < m) {
+			if (folded(text[i]) == pattern[j]) {
+				i++;
+				j++;
+			}
+
+			if (j == n) {
+				if (acceptMatch(i - j, j))
+					found_in.push_back(i - j);
+				j = lps[j - 1];
+			}
+			else if (i < m && folded(text[i]) != pattern[j]) {
+				if (j != 0) {
+					j = lps[j - 1];
+				}
+				else {
+					i++;
+				}
+			}
+		}
+
+		return found_in;
+	}
+
+
+	// KMP Algorithm compiled into a DFA (one lookup per text byte)
+	vector<int> searchKMPDFA(string pattern) {
+		if (pattern.length() <= SHORT_PATTERN)
+			return searchShort(pattern.data(), pattern.length());
+
+		KMPAutomaton dfa(pattern, ignoreCase);
+		vector<long long> hits;
+		dfa.feed(text.data(), text.length(), hits);
+
+		vector<int> found_in;
+		found_in.reserve(hits.size());
+		for (long long hit : hits) {
+			if (acceptMatch(hit, pattern.length()))
+				found_in.push_back(hit);
+		}
+		return found_in;
+	}
+
+
+	// Compile-time Patterns
+	// The tables come from CompiledPattern<P>, so these do no preprocessing
+	// at run time; find<P>() picks the kernel by the pattern length. Both the
+	// exact and the case-folded tables are compiled, setIgnoreCase() picks.
+	template <FixedString P>
+	vector<int> find() {
+		if constexpr (P.length() <= SHORT_PATTERN)
+			return searchShort(P.chars, P.length());
+		else
+			return horspool<P>();
+	}
+
+
+	template <FixedString P>
+	vector<int> horspool() {
+		if (ignoreCase)
+			return compiledHorspool<CompiledPattern<P, true>>();
+		return compiledHorspool<CompiledPattern<P, false>>();
+	}
+
+
+	template <FixedString P>
+	vector<int> searchKMP() {
+		if (ignoreCase)
+			return compiledKMP<CompiledPattern<P, true>>();
+		return compiledKMP<CompiledPattern<P, false>>();
+	}
+
+
+	// Bit-parallel Shift-And over the compile-time masks (m <= 64)
+	template <FixedString P>
+	vector<int> shiftAnd() {
+		static_assert(P.length() <= 64, "shiftAnd needs a pattern of at most 64 bytes");
+		if (ignoreCase)
+			return compiledShiftAnd<CompiledPattern<P, true>>();
+		return compiledShiftAnd<CompiledPattern<P, false>>();
+	}
+
+
+	template <typename C>
+	vector<int> compiledHorspool() {
+		constexpr int m = C::m;
+		vector<int> found_in;
+		int n = text.length();
+		if (m == 0 || m > n) return found_in;
+
+		const char* s = text.data();
+		for (int i = 0; i <= n - m; ) {
+			if (C::equals(s + i) && acceptMatch(i, m))
+				found_in.push_back(i);
+			i += C::shift[(unsigned char)s[i + m - 1]];
+		}
+
+		return found_in;
+	}
+
+
+	template <typename C>
+	vector<int> compiledKMP() {
+		constexpr int m = C::m;
+		vector<int> found_in;
+		int n = text.length();
+		if (m == 0) return found_in;
+
+		for (int i = 0, j = 0; i < n; ) {
+			if (C::key(text[i]) == C::chars[j]) {
+				i++;
+				j++;
+				if (j == m) {
+					if (acceptMatch(i - j, j))
+						found_in.push_back(i - j);
+					j = C::lps[j - 1];
+				}
+			}
+			else if (j != 0) {
+				j = C::lps[j - 1];
+			}
+			else {
+				i++;
+			}
+		}
+
+		return found_in;
+	}
+
+
+	template <typename C>
+	vector<int> compiledShiftAnd() {
+		constexpr uint64_t accept = C::m == 0 ? 0 : uint64_t(1) << (C::m - 1);
+		vector<int> found_in;
+		int n = text.length();
+		if (C::m == 0) return found_in;
+
+		uint64_t state = 0;
+		for (int i = 0; i < n; i++) {
+			state = ((state << 1) | 1) & C::masks[(unsigned char)text[i]];
+			if ((state & accept) && acceptMatch(i - C::m + 1, C::m))
+				found_in.push_back(i - C::m + 1);
+		}
+
+		return found_in;
+	}
+
+
+	// Multi-pattern Search (Aho-Corasick)
+	// One pass over the text for a whole keyword set (StaticAhoCorasick or
+	// AhoCorasick): onMatch(keyword, start) fires for every occurrence and
+	// onByte(c) sees every text byte, so callers can gather other per-byte
+	// statistics in the same loop.
+	template <typename Automaton, typename F, typename G>
+	void searchKeywords(const Automaton& automaton, F onMatch, G onByte) {
+		searchKeywords(text, wholeWord, automaton, onMatch, onByte);
+	}
+
+
+	// The same over a caller's buffer, for callers that only need this
+	// pass and should not copy the text into a StringMatching
+	template <typename Automaton, typename F, typename G>
+	static void searchKeywords(string_view text, bool wholeWord, const Automaton& automaton, F onMatch, G onByte) {
+		int n = text.length();
+		int state = 0;
+		int end = 0;
+
+		auto verified = [&](int keyword, int start) {
+			if (!wholeWord || wordBounded(text, start, end - start + 1))
+				onMatch(keyword, start);
+		};
+
+		for (; end < n; end++) {
+			unsigned char c = text[end];
+			onByte(c);
+			state = automaton.next(state, c);
+			automaton.report(state, end, verified);
+		}
+	}
+
+
+	template <typename Automaton, typename F>
+	void searchKeywords(const Automaton& automaton, F onMatch) {
+		searchKeywords(automaton, onMatch, [](unsigned char) {});
+	}
+
+
+	vector<int> horspool(string pattern) {
+		if (pattern.length() <= SHORT_PATTERN)
+			return searchShort(pattern.data(), pattern.length());
+
+		pattern = foldPattern(pattern);
+		unordered_map<char, int> values = horspoolHelper(pattern);
+		vector<int> found_in;
+
+		int i = pattern.length() - 1;
+
+		while (i < text.length()) {
+			for (int j = 0; j < pattern.length(); j++) {
+				if (pattern[pattern.length() - 1 - j] != folded(text[i - j])) {
+					if (values.find(folded(text[i])) == values.end())
+						i += pattern.length();
+					else
+						i += values[folded(text[i])];
+					break;
+				}
+				if (j == pattern.length() - 1) {
+					if (acceptMatch(i - j, pattern.length()))
+						found_in.push_back(i-j);
+					i++;
+				}
+			}
+		}
+
+		return found_in;
+	}
+};
@@ -0,0 +1,499 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+
+// Suffix Array Index
+// For many queries against one fixed text: the suffix array is built once
+// with SA-IS (linear time), the LCP array with Kasai's algorithm. A pattern
+// occurs exactly at the suffixes of one contiguous SA range, found by two
+// binary searches; the LCP of the pattern with both ends of the search
+// interval is carried along (the Manber-Myers "mlr" trick), so comparisons
+// resume where they left off instead of restarting at the first byte.
+//
+// With ignoreCase the suffixes are sorted by their case-folded bytes (A-Z
+// as a-z), and patterns are folded the same way. The text must outlive the
+// index; save() / load() keep the arrays on disk so a large document is only
+// indexed once.
+//
+// Construction can use several threads (prefix doubling with a parallel
+// radix sort, see prefixDoubling); the result is the same array.
+class SuffixArray {
+protected:
+	static const uint32_t MAGIC = 0x58494153;	// "SAIX"
+	static const uint32_t VERSION = 1;
+
+	const char* data = nullptr;
+	int size = 0;
+	bool folded = false;
+	vector<int> sa;
+	// lcp[i]: longest common prefix of suffixes sa[i - 1] and sa[i] (lcp[0] = 0)
+	vector<int> lcp;
+
+
+	unsigned char symbol(int i) const {
+		unsigned char c = data[i];
+		return (folded && c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+	}
+
+
+	// SA-IS (Nong, Zhang & Chan). s holds symbols in [0, upper]; the end of
+	// the string acts as a virtual sentinel smaller than every symbol.
+	static vector<int> sais(const vector<int>& s, int upper) {
+		int n = s.size();
+		if (n == 0) return {};
+		if (n == 1) return { 0 };
+		if (n == 2) return s[0] < s[1] ? vector<int>{ 0, 1 } : vector<int>{ 1, 0 };
+
+		// Suffix types: true for S (smaller than the next suffix), false for L
+		vector<int> sa(n);
+		vector<bool> type(n);
+		for (int i = n - 2; i >= 0; i--)
+			type[i] = s[i] == s[i + 1] ? type[i + 1] : s[i] < s[i + 1];
+
+		// Bucket starts for S-suffixes (sumS) and L-suffixes (sumL) of each symbol
+		vector<int> sumL(upper + 2), sumS(upper + 2);
+		for (int i = 0; i < n; i++) {
+			if (!type[i]) sumS[s[i]]++;
+			else sumL[s[i] + 1]++;
+		}
+		for (int c = 0; c <= upper; c++) {
+			sumS[c] += sumL[c];
+			sumL[c + 1] += sumS[c];
+		}
+
+		vector<int> bucket(upper + 2);
+		auto induce = [&](const vector<int>& lms) {
+			fill(sa.begin(), sa.end(), -1);
+			copy(sumS.begin(), sumS.end(), bucket.begin());
+			for (int d : lms) {
+				if (d != n) sa[bucket[s[d]]++] = d;
+			}
+			copy(sumL.begin(), sumL.end(), bucket.begin());
+			sa[bucket[s[n - 1]]++] = n - 1;
+			for (int i = 0; i < n; i++) {
+				int v = sa[i];
+				if (v >= 1 && !type[v - 1])
+					sa[bucket[s[v - 1]]++] = v - 1;
+			}
+			copy(sumL.begin(), sumL.end(), bucket.begin());
+			for (int i = n - 1; i >= 0; i--) {
+				int v = sa[i];
+				if (v >= 1 && type[v - 1])
+					sa[--bucket[s[v - 1] + 1]] = v - 1;
+			}
+		};
+
+		// LMS positions (an S-suffix right after an L-suffix), numbered left to right
+		vector<int> lmsIndex(n + 1, -1);
+		vector<int> lms;
+		for (int i = 1; i < n; i++) {
+			if (!type[i - 1] && type[i]) {
+				lmsIndex[i] = lms.size();
+				lms.push_back(i);
+			}
+		}
+		int m = lms.size();
+
+		induce(lms);
+		if (m == 0) return sa;
+
+		// Name the LMS substrings in sorted order; equal substrings share a name
+		vector<int> sorted;
+		sorted.reserve(m);
+		for (int v : sa) {
+			if (lmsIndex[v] != -1) sorted.push_back(v);
+		}
+		vector<int> reduced(m);
+		int names = 0;
+		reduced[lmsIndex[sorted[0]]] = 0;
+		for (int i = 1; i < m; i++) {
+			int l = sorted[i - 1], r = sorted[i];
+			int endL = lmsIndex[l] + 1 < m ? lms[lmsIndex[l] + 1] : n;
+			int endR = lmsIndex[r] + 1 < m ? lms[lmsIndex[r] + 1] : n;
+			bool same = endL - l == endR - r;
+			if (same) {
+				while (l < endL && s[l] == s[r]) {
+					l++;
+					r++;
+				}
+				if (l == n || s[l] != s[r]) same = false;
+			}
+			if (!same) names++;
+			reduced[lmsIndex[sorted[i]]] = names;
+		}
+
+		// Sort the reduced string recursively, then induce the full order
+		vector<int> reducedSA = sais(reduced, names);
+		for (int i = 0; i < m; i++)
+			sorted[i] = lms[reducedSA[i]];
+		induce(sorted);
+		return sa;
+	}
+
+
+	// Runs f(begin, end, t) on slice t of [0, n) for every t < threads, each
+	// slice on its own thread
+	template <typename F>
+	static void parallelFor(int threads, size_t n, F f) {
+		vector<thread> pool;
+		for (int t = 1; t < threads; t++)
+			pool.emplace_back(f, n * t / threads, n * (t + 1) / threads, t);
+		f(0, n / threads, 0);
+		for (auto& worker : pool)
+			worker.join();
+	}
+
+
+	// Stable LSD radix sort of (key, index) pairs on the low `bits` bits of
+	// the keys, 11 bits per pass. Every thread counts the digits of its slice;
+	// the offsets are summed digit-major, thread-minor, so each thread then
+	// scatters its slice into its own ranges and the order stays stable.
+	static void radixSort(vector<uint64_t>& keys, vector<int>& index, int bits, int threads) {
+		const int DIGIT = 11;
+		const int BUCKETS = 1 << DIGIT;
+		size_t n = keys.size();
+		vector<uint64_t> keysOut(n);
+		vector<int> indexOut(n);
+		vector<size_t> offsets(threads * BUCKETS);
+
+		for (int shift = 0; shift < bits; shift += DIGIT) {
+			parallelFor(threads, n, [&](size_t begin, size_t end, int t) {
+				size_t* count = &offsets[t * BUCKETS];
+				fill(count, count + BUCKETS, 0);
+				for (size_t i = begin; i < end; i++)
+					count[(keys[i] >> shift) & (BUCKETS - 1)]++;
+			});
+
+			size_t sum = 0;
+			for (int d = 0; d < BUCKETS; d++) {
+				for (int t = 0; t < threads; t++) {
+					size_t count = offsets[t * BUCKETS + d];
+					offsets[t * BUCKETS + d] = sum;
+					sum += count;
+				}
+			}
+
+			parallelFor(threads, n, [&](size_t begin, size_t end, int t) {
+				size_t* next = &offsets[t * BUCKETS];
+				for (size_t i = begin; i < end; i++) {
+					size_t at = next[(keys[i] >> shift) & (BUCKETS - 1)]++;
+					keysOut[at] = keys[i];
+					indexOut[at] = index[i];
+				}
+			});
+			keys.swap(keysOut);
+			index.swap(indexOut);
+		}
+	}
+
+
+	// Prefix doubling (Manber & Myers): once suffixes are ranked by their
+	// first h bytes, one round radix sorts the pairs (rank[i], rank[i + h])
+	// packed into one key and ranks them by 2h bytes; the new rank of a suffix
+	// is the SA position where its group of equal keys starts. The first
+	// round packs as many leading bytes as fit in 63 bits (with the alphabet
+	// renumbered densely, 21 for DNA, 9 for English text) instead of one.
+	// Stops once every rank is distinct.
+	static vector<int> prefixDoubling(const vector<int>& s, int threads) {
+		int n = s.size();
+		vector<int> sa(n);
+		if (n < 2 || threads < 2 || n < threads * 4096) {
+			// Too small to be worth the threads
+			return n < 2 ? vector<int>(n, 0) : sais(s, 255);
+		}
+
+		// Dense codes 1..sigma, 0 is past the end of the text
+		int code[256] = {};
+		for (int c : s)
+			code[c] = 1;
+		int sigma = 0;
+		for (int c = 0; c < 256; c++) {
+			if (code[c]) code[c] = ++sigma;
+		}
+		int symbolBits = 64 - __builtin_clzll(sigma);
+		int packed = 63 / symbolBits;
+
+		vector<int> rank(n);
+		vector<uint64_t> keys(n);
+		vector<int> lastStart(threads), groups(threads);
+		for (int h = 0; ; h = h == 0 ? packed : h * 2) {
+			int bits;
+			if (h == 0) {
+				bits = symbolBits * packed;
+				parallelFor(threads, n, [&](size_t begin, size_t end, int) {
+					for (size_t i = begin; i < end; i++) {
+						uint64_t key = 0;
+						for (int k = 0; k < packed; k++)
+							key = (key << symbolBits) | (i + k < (size_t)n ? code[s[i + k]] : 0);
+						sa[i] = i;
+						keys[i] = key;
+					}
+				});
+			}
+			else {
+				// rank[i + h] + 1, or 0 past the end of the text
+				uint64_t width = n + 1;
+				bits = 64 - __builtin_clzll(uint64_t(n) * width - 1);
+				parallelFor(threads, n, [&](size_t begin, size_t end, int) {
+					for (size_t i = begin; i < end; i++) {
+						sa[i] = i;
+						keys[i] = rank[i] * width + (i + h < (size_t)n ? rank[i + h] + 1 : 0);
+					}
+				});
+			}
+			radixSort(keys, sa, bits, threads);
+
+			// Group starts: a slice's first group may begin in an earlier slice
+			parallelFor(threads, n, [&](size_t begin, size_t end, int t) {
+				lastStart[t] = -1;
+				groups[t] = 0;
+				for (size_t i = max<size_t>(begin, 1); i < end; i++) {
+					if (keys[i] != keys[i - 1]) {
+						lastStart[t] = i;
+						groups[t]++;
+					}
+				}
+			});
+			vector<int> carry(threads, 0);
+			int distinct = 1;
+			for (int t = 0; t < threads; t++) {
+				if (t > 0) carry[t] = lastStart[t - 1] >= 0 ? lastStart[t - 1] : carry[t - 1];
+				distinct += groups[t];
+			}
+			parallelFor(threads, n, [&](size_t begin, size_t end, int t) {
+				int start = carry[t];
+				for (size_t i = begin; i < end; i++) {
+					if (i > 0 && keys[i] != keys[i - 1]) start = i;
+					rank[sa[i]] = start;
+				}
+			});
+
+			if (distinct == n || (h > 0 && h * 2 >= n)) break;
+		}
+		return sa;
+	}
+
+
+	// Kasai et al.: walks the suffixes in text order, the LCP drops by at
+	// most one from one text position to the next. Slices of the text run on
+	// separate threads, each restarting from h = 0.
+	void buildLCP(int threads = 1) {
+		vector<int> rank(size);
+		lcp.assign(size, 0);
+		threads = size < threads * 4096 ? 1 : threads;
+
+		parallelFor(threads, size, [&](size_t begin, size_t end, int) {
+			for (size_t i = begin; i < end; i++)
+				rank[sa[i]] = i;
+		});
+		parallelFor(threads, size, [&](size_t begin, size_t end, int) {
+			int h = 0;
+			for (int i = begin; i < (int)end; i++) {
+				if (h > 0) h--;
+				if (rank[i] == 0) {
+					h = 0;
+					continue;
+				}
+				int j = sa[rank[i] - 1];
+				while (i + h < size && j + h < size && symbol(i + h) == symbol(j + h))
+					h++;
+				lcp[rank[i]] = h;
+			}
+		});
+	}
+
+
+	// Compares the suffix at `at` with the pattern, skipping the first
+	// `matched` bytes that are known to be equal. Returns <0, 0 (the pattern
+	// is a prefix of the suffix) or >0 and leaves the common length in matched.
+	int compare(int at, const string& pattern, int& matched) const {
+		int m = pattern.length();
+		while (matched < m && at + matched < size) {
+			int d = (int)symbol(at + matched) - (int)(unsigned char)pattern[matched];
+			if (d != 0) return d;
+			matched++;
+		}
+		return matched == m ? 0 : -1;
+	}
+
+
+	// First SA index whose suffix is >= pattern (lower) or does not start
+	// with the pattern and is greater (upper)
+	int bound(const string& pattern, bool upper) const {
+		int lo = 0, hi = size;
+		int lowMatch = 0, highMatch = 0;
+		while (lo < hi) {
+			int mid = lo + (hi - lo) / 2;
+			int matched = min(lowMatch, highMatch);
+			int c = compare(sa[mid], pattern, matched);
+			if (c < 0 || (upper && c == 0)) {
+				lo = mid + 1;
+				lowMatch = matched;
+			}
+			else {
+				hi = mid;
+				highMatch = matched;
+			}
+		}
+		return lo;
+	}
+
+
+	string foldPattern(string pattern) const {
+		if (folded) {
+			for (char& c : pattern) {
+				if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+			}
+		}
+		return pattern;
+	}
+
+
+	static uint64_t checksum(const char* p, size_t n) {
+		uint64_t hash = 1469598103934665603ULL;
+		for (size_t i = 0; i < n; i++) {
+			hash ^= (unsigned char)p[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+public:
+	SuffixArray() {}
+
+
+	SuffixArray(const char* text, int length, bool ignoreCase = false, int threads = 1) {
+		data = text;
+		size = length;
+		folded = ignoreCase;
+		sa = suffixOrder(text, length, ignoreCase, threads);
+		buildLCP(threads);
+	}
+
+
+	// The suffix array alone, for indexes that do not need the LCP. SA-IS on
+	// one thread, prefix doubling when more are given.
+	static vector<int> suffixOrder(const char* text, int length, bool ignoreCase = false, int threads = 1) {
+		vector<int> s(length);
+		for (int i = 0; i < length; i++) {
+			unsigned char c = text[i];
+			s[i] = (ignoreCase && c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+		}
+		if (threads > 1)
+			return prefixDoubling(s, threads);
+		return sais(s, 255);
+	}
+
+
+	const char* text() const { return data; }
+
+
+	bool ignoresCase() const { return folded; }
+
+
+	const vector<int>& suffixes() const { return sa; }
+
+
+	const vector<int>& lcpArray() const { return lcp; }
+
+
+	// SA range [first, last) of the suffixes that start with the pattern
+	pair<int, int> range(string pattern) const {
+		if (pattern.empty()) return { 0, 0 };
+		pattern = foldPattern(pattern);
+		return { bound(pattern, false), bound(pattern, true) };
+	}
+
+
+	int count(string pattern) const {
+		pair<int, int> r = range(pattern);
+		return r.second - r.first;
+	}
+
+
+	// Start offsets of every occurrence, ascending
+	vector<int> locate(string pattern) const {
+		pair<int, int> r = range(pattern);
+		vector<int> found_in(sa.begin() + r.first, sa.begin() + r.second);
+		sort(found_in.begin(), found_in.end());
+		return found_in;
+	}
+
+
+	// Longest substring that occurs at least twice, as (offset, length)
+	pair<int, int> longestRepeat() const {
+		int best = 0;
+		for (int i = 1; i < size; i++) {
+			if (lcp[i] > lcp[best]) best = i;
+		}
+		if (size == 0 || lcp[best] == 0) return { 0, 0 };
+		return { sa[best], lcp[best] };
+	}
+
+
+	// File layout: magic, version, flags, text length, text checksum (FNV-1a),
+	// then the SA and LCP arrays as 32-bit integers
+	bool save(const string& path) const {
+		ofstream out(path, ios::binary);
+		if (!out) return false;
+
+		uint32_t header[4] = { MAGIC, VERSION, uint32_t(folded), uint32_t(size) };
+		uint64_t hash = checksum(data, size);
+		out.write((const char*)header, sizeof(header));
+		out.write((const char*)&hash, sizeof(hash));
+		out.write((const char*)sa.data(), sa.size() * sizeof(int));
+		out.write((const char*)lcp.data(), lcp.size() * sizeof(int));
+		return bool(out);
+	}
+
+
+	// Attaches a saved index to its text; false (and the index left empty)
+	// when the file is missing, from another version, for another text or
+	// inconsistent
+	bool load(const string& path, const char* text, int length) {
+		*this = SuffixArray();
+		ifstream in(path, ios::binary);
+		if (!in) return false;
+
+		uint32_t header[4];
+		uint64_t hash;
+		if (!in.read((char*)header, sizeof(header)) || !in.read((char*)&hash, sizeof(hash)))
+			return false;
+		if (header[0] != MAGIC || header[1] != VERSION || header[3] != uint32_t(length))
+			return false;
+		if (hash != checksum(text, length))
+			return false;
+
+		vector<int> suffixes(length), prefixes(length);
+		if (!in.read((char*)suffixes.data(), length * sizeof(int)) || !in.read((char*)prefixes.data(), length * sizeof(int)))
+			return false;
+
+		// The arrays are used unchecked, so a corrupt file must not get
+		// past here: sa a permutation of the offsets, every lcp within
+		// both suffixes it compares
+		vector<bool> seen(length, false);
+		for (int i = 0; i < length; i++) {
+			int at = suffixes[i];
+			if (at < 0 || at >= length || seen[at]) return false;
+			seen[at] = true;
+			int limit = i == 0 ? 0 : min(length - at, length - suffixes[i - 1]);
+			if (prefixes[i] < 0 || prefixes[i] > limit) return false;
+		}
+
+		data = text;
+		size = length;
+		folded = header[2] != 0;
+		sa = move(suffixes);
+		lcp = move(prefixes);
+		return true;
+	}
+};
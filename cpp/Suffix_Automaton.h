@@ -0,0 +1,235 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+
+// Longest common substring of two texts: offset in each and length
+struct CommonSubstring {
+	int offset = 0;
+	int otherOffset = 0;
+	int length = 0;
+};
+
+
+// Suffix Automaton
+// The smallest DFA accepting every substring of the text, built online in
+// O(n) (Blumer et al.): at most 2n states and 3n transitions. Each state is
+// a class of substrings with the same end positions; it keeps the size of
+// that set (occurrence count) and the first end position, so "does it
+// occur", "how often" and "where first" are a walk over the pattern, O(m).
+// Walking another document through the automaton finds the longest common
+// substring in O(length of that document).
+//
+// Transitions are kept in per-state edge lists: the alphabet is 256 bytes
+// but states have few edges, so a list is far smaller than a table. With
+// ignoreCase the automaton is built over the case-folded text.
+class SuffixAutomaton {
+protected:
+	struct State {
+		int len;
+		int link;
+		int edges;	// first edge, -1 for none
+		int firstEnd;
+		// Clones split off an existing state and end no prefix of their own
+		bool clone;
+	};
+
+	struct Edge {
+		unsigned char label;
+		int target;
+		int next;
+	};
+
+	const char* source = nullptr;
+	bool folded = false;
+	vector<State> states;
+	vector<Edge> edges;
+	// Occurrence count (end position set size) per state, set by finish()
+	vector<long long> counts;
+	// The root has an edge for every distinct byte of the text and is
+	// visited constantly, so its transitions are a direct table
+	int rootEdges[256];
+	int last = 0;
+	int size = 0;
+
+
+	unsigned char fold(unsigned char c) const {
+		return (folded && c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+	}
+
+
+	int transition(int state, unsigned char c) const {
+		if (state == 0) return rootEdges[c];
+		for (int e = states[state].edges; e != -1; e = edges[e].next) {
+			if (edges[e].label == c) return edges[e].target;
+		}
+		return -1;
+	}
+
+
+	void setTransition(int state, unsigned char c, int target) {
+		if (state == 0) {
+			rootEdges[c] = target;
+			return;
+		}
+		for (int e = states[state].edges; e != -1; e = edges[e].next) {
+			if (edges[e].label == c) {
+				edges[e].target = target;
+				return;
+			}
+		}
+		edges.push_back({ c, target, states[state].edges });
+		states[state].edges = edges.size() - 1;
+	}
+
+
+	// State reached by the whole pattern, -1 when it is not a substring
+	int walk(const string& pattern) const {
+		int state = 0;
+		for (char c : pattern) {
+			state = transition(state, fold(c));
+			if (state == -1) return -1;
+		}
+		return state;
+	}
+
+public:
+	SuffixAutomaton() {
+		states.push_back({ 0, -1, -1, -1, true });
+		fill(rootEdges, rootEdges + 256, -1);
+	}
+
+
+	SuffixAutomaton(const char* text, int length, bool ignoreCase = false) : SuffixAutomaton() {
+		source = text;
+		folded = ignoreCase;
+		states.reserve(2 * length + 1);
+		edges.reserve(3 * length);
+		for (int i = 0; i < length; i++)
+			extend(text[i]);
+		finish();
+	}
+
+
+	// Appends one byte to the text. The occurrence counts are stale until
+	// finish() is called.
+	void extend(char ch) {
+		unsigned char c = fold(ch);
+		int current = states.size();
+		states.push_back({ states[last].len + 1, 0, -1, size, false });
+		size++;
+
+		int p = last;
+		while (p != -1 && transition(p, c) == -1) {
+			setTransition(p, c, current);
+			p = states[p].link;
+		}
+
+		if (p != -1) {
+			int q = transition(p, c);
+			if (states[p].len + 1 == states[q].len) {
+				states[current].link = q;
+			}
+			else {
+				// Split q: the clone takes the shorter strings and q's edges
+				int clone = states.size();
+				states.push_back({ states[p].len + 1, states[q].link, -1, states[q].firstEnd, true });
+				for (int e = states[q].edges; e != -1; e = edges[e].next) {
+					edges.push_back({ edges[e].label, edges[e].target, states[clone].edges });
+					states[clone].edges = edges.size() - 1;
+				}
+				while (p != -1 && transition(p, c) == q) {
+					setTransition(p, c, clone);
+					p = states[p].link;
+				}
+				states[q].link = clone;
+				states[current].link = clone;
+			}
+		}
+		last = current;
+	}
+
+
+	// Occurrence counts: every state passes its end positions to its suffix
+	// link, visited by decreasing length (a counting sort by len)
+	void finish() {
+		int n = states.size();
+		vector<int> byLength(size + 2, 0);
+		for (const State& s : states)
+			byLength[s.len + 1]++;
+		for (int l = 1; l < (int)byLength.size(); l++)
+			byLength[l] += byLength[l - 1];
+		vector<int> order(n);
+		for (int s = 0; s < n; s++)
+			order[byLength[states[s].len]++] = s;
+
+		counts.assign(n, 0);
+		for (int s = 0; s < n; s++)
+			counts[s] = !states[s].clone;
+		for (int k = n - 1; k > 0; k--) {
+			int s = order[k];
+			counts[states[s].link] += counts[s];
+		}
+	}
+
+
+	const char* text() const { return source; }
+
+
+	bool ignoresCase() const { return folded; }
+
+
+	int stateCount() const { return states.size(); }
+
+
+	bool occurs(const string& pattern) const {
+		return walk(pattern) != -1;
+	}
+
+
+	// Number of (possibly overlapping) occurrences
+	long long count(const string& pattern) const {
+		if (pattern.empty()) return 0;
+		int state = walk(pattern);
+		return state == -1 ? 0 : counts[state];
+	}
+
+
+	// Start offset of the first occurrence, -1 when there is none
+	int firstOccurrence(const string& pattern) const {
+		if (pattern.empty()) return -1;
+		int state = walk(pattern);
+		return state == -1 ? -1 : states[state].firstEnd - pattern.length() + 1;
+	}
+
+
+	// Runs the other text through the automaton, falling back along suffix
+	// links on a mismatch, and keeps the longest match seen
+	CommonSubstring longestCommonSubstring(const char* other, int length) const {
+		CommonSubstring best;
+		int state = 0, matched = 0;
+		for (int i = 0; i < length; i++) {
+			unsigned char c = fold(other[i]);
+			while (state != 0 && transition(state, c) == -1) {
+				state = states[state].link;
+				matched = states[state].len;
+			}
+			int next = transition(state, c);
+			if (next == -1) continue;
+			state = next;
+			matched++;
+
+			if (matched > best.length) {
+				best.length = matched;
+				best.otherOffset = i - matched + 1;
+				best.offset = states[state].firstEnd - matched + 1;
+			}
+		}
+		return best;
+	}
+};
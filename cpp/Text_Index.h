@@ -0,0 +1,313 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+
+// UTF-8 Offset Index
+// The search algorithms report byte offsets, while the web front end counts
+// positions in UTF-16 code units (JavaScript string indices). This index
+// validates the text once and keeps rank-style checkpoints: absolute code
+// point / UTF-16 counts every 64 KiB and 16-bit counts relative to those every
+// 64 bytes. A lookup is one checkpoint read plus a popcount over the 64-byte
+// block, so translating any offset costs O(1).
+//
+// Code points are the bytes that are not continuation bytes (10xxxxxx); a
+// 4-byte leader (11110xxx) adds a second UTF-16 unit (the surrogate pair).
+// The text must outlive the index.
+class Utf8Index {
+protected:
+	static const int BLOCK = 64;
+	static const int SUPER_BLOCK = 65536;
+
+	const char* data = nullptr;
+	size_t size = 0;
+	size_t invalidAt = string::npos;
+	vector<uint64_t> superCodePoints, superUtf16;
+	vector<uint16_t> blockCodePoints, blockUtf16;
+
+
+	// Bit i of cont / lead4 is set when byte i of the block is a continuation
+	// byte / a 4-byte leader. Blocks shorter than 64 bytes are zero padded.
+	static void blockMasks(const char* p, size_t available, uint64_t& cont, uint64_t& lead4) {
+		char padded[BLOCK];
+		if (available < BLOCK) {
+			memset(padded, 0, BLOCK);
+			memcpy(padded, p, available);
+			p = padded;
+		}
+
+		cont = 0;
+		lead4 = 0;
+#ifdef __SSE2__
+		for (int k = 0; k < BLOCK; k += 16) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(p + k));
+			// 0x80..0xBF is -128..-65 as signed bytes, 0xF0..0xFF is -16..-1
+			unsigned c = _mm_movemask_epi8(_mm_cmplt_epi8(x, _mm_set1_epi8(-64)));
+			unsigned l = _mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(-17)), _mm_cmplt_epi8(x, _mm_setzero_si128())));
+			cont |= uint64_t(c) << k;
+			lead4 |= uint64_t(l) << k;
+		}
+#else
+		for (int k = 0; k < BLOCK; k++) {
+			unsigned char b = p[k];
+			cont |= uint64_t((b & 0xC0) == 0x80) << k;
+			lead4 |= uint64_t(b >= 0xF0) << k;
+		}
+#endif
+	}
+
+
+	// Position of the first malformed sequence, or npos. Runs of ASCII are
+	// skipped 16 bytes at a time.
+	static size_t validate(const char* p, size_t n) {
+		const unsigned char* s = (const unsigned char*)p;
+		size_t i = 0;
+		while (i < n) {
+#ifdef __SSE2__
+			while (i + 16 <= n && _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(s + i))) == 0)
+				i += 16;
+			if (i >= n) break;
+#endif
+			unsigned char c = s[i];
+			if (c < 0x80) {
+				i++;
+				continue;
+			}
+
+			int extra;
+			unsigned char low = 0x80, high = 0xBF;
+			if (c >= 0xC2 && c <= 0xDF) extra = 1;
+			else if (c == 0xE0) { extra = 2; low = 0xA0; }
+			else if (c == 0xED) { extra = 2; high = 0x9F; }
+			else if (c >= 0xE1 && c <= 0xEF) extra = 2;
+			else if (c == 0xF0) { extra = 3; low = 0x90; }
+			else if (c == 0xF4) { extra = 3; high = 0x8F; }
+			else if (c >= 0xF1 && c <= 0xF3) extra = 3;
+			else return i;
+
+			if (i + extra >= n) return i;
+			if (s[i + 1] < low || s[i + 1] > high) return i;
+			for (int k = 2; k <= extra; k++) {
+				if ((s[i + k] & 0xC0) != 0x80) return i;
+			}
+			i += extra + 1;
+		}
+		return string::npos;
+	}
+
+
+	// Counts up to (not including) byteOffset
+	void countTo(size_t byteOffset, size_t& codePoints, size_t& utf16) const {
+		size_t block = byteOffset / BLOCK;
+		size_t superBlock = byteOffset / SUPER_BLOCK;
+		codePoints = superCodePoints[superBlock];
+		utf16 = superUtf16[superBlock];
+		if (block < blockCodePoints.size()) {
+			codePoints += blockCodePoints[block];
+			utf16 += blockUtf16[block];
+		}
+
+		int inBlock = byteOffset % BLOCK;
+		if (inBlock == 0) return;
+		uint64_t cont, lead4;
+		blockMasks(data + block * BLOCK, size - block * BLOCK, cont, lead4);
+		uint64_t below = (uint64_t(1) << inBlock) - 1;
+		codePoints += inBlock - __builtin_popcountll(cont & below);
+		utf16 += inBlock - __builtin_popcountll(cont & below) + __builtin_popcountll(lead4 & below);
+	}
+
+public:
+	Utf8Index() {
+		superCodePoints.assign(1, 0);
+		superUtf16.assign(1, 0);
+	}
+
+
+	Utf8Index(const char* text, size_t length) {
+		data = text;
+		size = length;
+		invalidAt = validate(text, length);
+
+		size_t blocks = size / BLOCK + 1;
+		blockCodePoints.resize(blocks);
+		blockUtf16.resize(blocks);
+		superCodePoints.assign(size / SUPER_BLOCK + 1, 0);
+		superUtf16.assign(size / SUPER_BLOCK + 1, 0);
+
+		uint64_t codePoints = 0, utf16 = 0;
+		uint64_t superBaseCodePoints = 0, superBaseUtf16 = 0;
+		for (size_t b = 0; b < blocks; b++) {
+			size_t offset = b * BLOCK;
+			if (offset % SUPER_BLOCK == 0) {
+				superBaseCodePoints = codePoints;
+				superBaseUtf16 = utf16;
+				superCodePoints[offset / SUPER_BLOCK] = codePoints;
+				superUtf16[offset / SUPER_BLOCK] = utf16;
+			}
+			blockCodePoints[b] = codePoints - superBaseCodePoints;
+			blockUtf16[b] = utf16 - superBaseUtf16;
+
+			size_t available = min<size_t>(BLOCK, size - offset);
+			if (available == 0) break;
+			uint64_t cont, lead4;
+			blockMasks(data + offset, available, cont, lead4);
+			uint64_t inside = available == BLOCK ? ~uint64_t(0) : (uint64_t(1) << available) - 1;
+			int points = available - __builtin_popcountll(cont & inside);
+			codePoints += points;
+			utf16 += points + __builtin_popcountll(lead4 & inside);
+		}
+	}
+
+
+	const char* text() const { return data; }
+
+
+	bool valid() const { return invalidAt == string::npos; }
+
+
+	// Byte offset of the first malformed sequence, npos for valid UTF-8
+	size_t firstInvalid() const { return invalidAt; }
+
+
+	size_t codePointOffset(size_t byteOffset) const {
+		size_t codePoints, utf16;
+		countTo(min(byteOffset, size), codePoints, utf16);
+		return codePoints;
+	}
+
+
+	size_t utf16Offset(size_t byteOffset) const {
+		size_t codePoints, utf16;
+		countTo(min(byteOffset, size), codePoints, utf16);
+		return utf16;
+	}
+
+
+	// Inverse of utf16Offset: the byte offset of the code point holding the
+	// given UTF-16 unit (a unit inside a surrogate pair maps to its start)
+	size_t byteOffsetFromUtf16(size_t units) const {
+		size_t superBlock = upper_bound(superUtf16.begin(), superUtf16.end(), units) - superUtf16.begin() - 1;
+		size_t first = superBlock * (SUPER_BLOCK / BLOCK);
+		size_t last = min(blockUtf16.size(), first + SUPER_BLOCK / BLOCK);
+		size_t relative = units - superUtf16[superBlock];
+		size_t block = upper_bound(blockUtf16.begin() + first, blockUtf16.begin() + last, relative) - blockUtf16.begin() - 1;
+
+		size_t offset = block * BLOCK;
+		size_t at = superUtf16[superBlock] + blockUtf16[block];
+		const unsigned char* s = (const unsigned char*)data;
+		while (offset < size) {
+			unsigned char c = s[offset];
+			if ((c & 0xC0) != 0x80) {
+				size_t width = c >= 0xF0 ? 2 : 1;
+				if (at + width > units) break;
+				at += width;
+			}
+			offset++;
+		}
+		return offset;
+	}
+};
+
+
+// Line Index
+// Replaces computeRowCol() in js/script.js, which rescans the text from the
+// start for every match. One SSE2 pass counts the newlines of every 64-byte
+// block and keeps the running count per block; a line number is then a
+// checkpoint read plus a popcount, and the start of a line is a binary search
+// over the checkpoints plus a bit select inside one block. Only '\n' ends a
+// line, as in computeRowCol(). The text must outlive the index.
+class LineIndex {
+protected:
+	static const int BLOCK = 64;
+
+	const char* data = nullptr;
+	size_t size = 0;
+	// Newlines before each block; one extra entry holds the total
+	vector<uint32_t> before;
+
+
+	uint64_t newlineMask(size_t block) const {
+		const char* p = data + block * BLOCK;
+		size_t available = min<size_t>(BLOCK, size - block * BLOCK);
+		char padded[BLOCK];
+		if (available < BLOCK) {
+			memset(padded, 0, BLOCK);
+			memcpy(padded, p, available);
+			p = padded;
+		}
+
+		uint64_t mask = 0;
+#ifdef __SSE2__
+		const __m128i newline = _mm_set1_epi8('\n');
+		for (int k = 0; k < BLOCK; k += 16) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(p + k));
+			mask |= uint64_t((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, newline))) << k;
+		}
+#else
+		for (int k = 0; k < BLOCK; k++)
+			mask |= uint64_t(p[k] == '\n') << k;
+#endif
+		return mask;
+	}
+
+public:
+	LineIndex() {
+		before.assign(2, 0);
+	}
+
+
+	LineIndex(const char* text, size_t length) {
+		data = text;
+		size = length;
+
+		size_t blocks = (size + BLOCK - 1) / BLOCK;
+		before.resize(blocks + 1);
+		uint32_t count = 0;
+		for (size_t b = 0; b < blocks; b++) {
+			before[b] = count;
+			count += __builtin_popcountll(newlineMask(b));
+		}
+		before[blocks] = count;
+	}
+
+
+	const char* text() const { return data; }
+
+
+	size_t lines() const { return before.back() + 1; }
+
+
+	// 0-based line holding byteOffset (the number of newlines before it)
+	size_t lineOf(size_t byteOffset) const {
+		byteOffset = min(byteOffset, size);
+		size_t block = byteOffset / BLOCK;
+		int inBlock = byteOffset % BLOCK;
+		if (inBlock == 0) return before[block];
+		return before[block] + __builtin_popcountll(newlineMask(block) & ((uint64_t(1) << inBlock) - 1));
+	}
+
+
+	// Byte offset where the 0-based line starts (just after its newline)
+	size_t lineStart(size_t line) const {
+		if (line == 0) return 0;
+		if (line > before.back()) return size;
+
+		// Block holding newline number `line` (1-based)
+		size_t rank = line - 1;
+		size_t block = upper_bound(before.begin(), before.end() - 1, (uint32_t)rank) - before.begin() - 1;
+		uint64_t mask = newlineMask(block);
+		for (size_t skip = rank - before[block]; skip > 0; skip--)
+			mask &= mask - 1;
+		return block * BLOCK + __builtin_ctzll(mask) + 1;
+	}
+};